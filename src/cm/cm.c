@@ -117,7 +117,7 @@ static void cm_ainit(arg_t **gen_argss, arg_t **check_argss,
 		gen_argss[OFFSET_B] = eq_arg;
 	}
 
-	if (cfg->points.type == POINTS_RANDOM) {
+	if (cfg->points.type == POINTS_RANDOM || cfg->points.amount) {
 		arg_t *points_arg = arg_new();
 		points_arg->args = &cfg->points.amount;
 		points_arg->nargs = 1;
@@ -104,6 +104,42 @@ int quit(int status) {
 	return status;
 }
 
+int generate(void) {
+	if (cfg->method == METHOD_CM || cfg->method == METHOD_ANOMALOUS ||
+	    cfg->method == METHOD_SUPERSINGULAR) {
+		return cm_do();
+	} else if (cfg->method == METHOD_INVALID) {
+		return invalid_do();
+	} else {
+		return exhaustive_do();
+	}
+}
+
+int batch(void) {
+	// the invalid curve method takes all the records in one run
+	if (cfg->method == METHOD_INVALID) {
+		return invalid_do();
+	}
+	int status = EXIT_SUCCESS;
+	unsigned long records = 0, failed = 0;
+	// the PARI state, seadata and output are shared by all the records
+	while (input_next()) {
+		pari_sp ltop = avma;
+		if (generate() != EXIT_SUCCESS) {
+			status = EXIT_FAILURE;
+			failed++;
+		}
+		avma = ltop;
+		records++;
+	}
+	if (failed) {
+		verbose_log("Processed %lu records, %lu failed.\n", records, failed);
+	} else {
+		verbose_log("Processed %lu records.\n", records);
+	}
+	return status;
+}
+
 /**
  * @mainpage
  *
@@ -165,13 +201,10 @@ int main(int argc, char *argv[]) {
 	}
 
 	int status;
-	if (cfg->method == METHOD_CM || cfg->method == METHOD_ANOMALOUS ||
-	    cfg->method == METHOD_SUPERSINGULAR) {
-		status = cm_do();
-	} else if (cfg->method == METHOD_INVALID) {
-		status = invalid_do();
+	if (cfg->batch) {
+		status = batch();
 	} else {
-		status = exhaustive_do();
+		status = generate();
 	}
 
 	return quit(status);
@@ -5,6 +5,7 @@
 
 #include "brainpool.h"
 #include "gen/gens.h"
+#include "gen/order.h"
 #include "gen/seed.h"
 #include "io/output.h"
 #include "math/subgroup.h"
@@ -246,7 +247,8 @@ GENERATOR(brainpool_gen_gens) {
 	point_t *G = point_new();
 	sub->generator = G;
 	G->point = ellmul(curve->curve, P, k);
-	G->order = ellorder(curve->curve, G->point, NULL);
+	G->order = ellorder(curve->curve, G->point,
+	                    mkvec2(curve->order, order_factors(curve)));
 	G->cofactor = divii(curve->order, G->order);
 	seed->brainpool.mult = k;
 	gerepileall(ltop, 4, &G->point, &G->order, &G->cofactor,
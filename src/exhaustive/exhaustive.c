@@ -8,6 +8,7 @@
 #include "brainpool.h"
 #include "brainpool_rfc.h"
 #include "check.h"
+#include "exhaustive_thread.h"
 #include "gen/curve.h"
 #include "gen/equation.h"
 #include "gen/field.h"
@@ -17,10 +18,12 @@
 #include "gen/order.h"
 #include "gen/point.h"
 #include "gen/seed.h"
+#include "io/checkpoint.h"
 #include "io/output.h"
 #include "misc/config.h"
 #include "obj/curve.h"
 #include "util/memory.h"
+#include "util/random.h"
 #include "util/timeout.h"
 
 void exhaustive_clear(exhaustive_t *setup) {
@@ -209,7 +212,9 @@ static void exhaustive_ginit(gen_f *generators) {
 }
 
 static void exhaustive_cinit(check_t **validators) {
-	check_t *curve_check = check_new(curve_check_nonzero, NULL);
+	// without the pre-filter, the NULL ends the checks early
+	check_f torsion_check = cfg->prefilter ? &curve_check_torsion : NULL;
+	check_t *curve_check = check_new(curve_check_nonzero, torsion_check, NULL);
 	validators[OFFSET_CURVE] = curve_check;
 
 	if (cfg->hex_check) {
@@ -238,7 +243,7 @@ static void exhaustive_cinit(check_t **validators) {
 }
 
 static void exhaustive_ainit(arg_t **gen_argss, arg_t **check_argss) {
-	if (cfg->points.type == POINTS_RANDOM) {
+	if (cfg->points.type == POINTS_RANDOM || cfg->points.amount) {
 		arg_t *points_arg = arg_new();
 		points_arg->args = &cfg->points.amount;
 		points_arg->nargs = 1;
@@ -256,6 +261,13 @@ static void exhaustive_ainit(arg_t **gen_argss, arg_t **check_argss) {
 		gen_argss[OFFSET_GENERATORS] = gens_arg;
 	}
 
+	if (cfg->prefilter) {
+		arg_t *curve_arg = arg_new();
+		curve_arg->args = &cfg->prefilter_bound;
+		curve_arg->nargs = 1;
+		check_argss[OFFSET_CURVE] = curve_arg;
+	}
+
 	if (cfg->hex_check) {
 		arg_t *point_arg = arg_new();
 		point_arg->args = cfg->hex_check;
@@ -274,7 +286,7 @@ void exhaustive_uinit(unroll_f *unrolls) {
 	unrolls[OFFSET_A] = &unroll_skip;
 	unrolls[OFFSET_B] = &unroll_skip;
 	unrolls[OFFSET_CURVE] = &curve_unroll;
-	unrolls[OFFSET_ORDER] = &unroll_skip;
+	unrolls[OFFSET_ORDER] = &order_unroll;
 	unrolls[OFFSET_GENERATORS] = &gens_unroll;
 	unrolls[OFFSET_POINTS] = &points_unroll;
 }
@@ -296,22 +308,55 @@ int exhaustive_gen_retry(curve_t *curve, const exhaustive_t *setup,
 	while (state < end_offset) {
 		stack_tops[state] = avma;
 
+		if ((setup->cancel && atomic_load(setup->cancel)) ||
+		    timeout_expired()) {
+			// someone else finished this curve or the run is out of time,
+			// throw away ours
+			for (int i = state; i > start_offset;) {
+				if (setup->unrolls && setup->unrolls[i]) {
+					i += setup->unrolls[i](curve, stack_tops[i],
+					                       stack_tops[i - 1]);
+				} else {
+					--i;
+				}
+			}
+			avma = stack_tops[start_offset];
+			return 0;
+		}
+
 		arg_t *gen_arg = setup->gen_argss ? setup->gen_argss[state] : NULL;
 		arg_t *check_arg =
 		    setup->check_argss ? setup->check_argss[state] : NULL;
 
+		double wall = 0, cpu = 0;
+		if (setup->stats) {
+			wall = stats_clock(CLOCK_MONOTONIC);
+			cpu = stats_clock(CLOCK_THREAD_CPUTIME_ID);
+		}
+
 		int diff;
 		bool timeout = false;
-		timeout_start(cfg->timeout) {
-			// This is not the best, but currently the best idea I have.
-			diff = start_offset - state;
-			timeout = true;
-		}
-		else {
+		bool rejected = false;
+		unsigned long time = cfg->timeout[state];
+		if (time || cfg->deadline) {
+			pari_CATCH(e_ALARM) {
+				// This is not the best, but currently the best idea I have.
+				timeout_stop();
+				diff = start_offset - state;
+				timeout = true;
+			}
+			pari_TRY {
+				timeout_start(time);
+				debug_log_state(state, "");
+				diff =
+				    setup->generators[state](curve, gen_arg, (offset_e)state);
+				timeout_stop();
+			}
+			pari_ENDCATCH;
+		} else {
 			debug_log_state(state, "");
 			diff = setup->generators[state](curve, gen_arg, (offset_e)state);
 		}
-		timeout_stop();
 		if (diff > 0 && setup->validators && setup->validators[state]) {
 			pari_sp ctop = avma;
 			check_t *validator = setup->validators[state];
@@ -320,12 +365,23 @@ int exhaustive_gen_retry(curve_t *curve, const exhaustive_t *setup,
 				    validator->checks[i](curve, check_arg, (offset_e)state);
 				if (new_diff <= 0) {
 					diff = new_diff;
+					rejected = true;
 					break;
 				}
 			}
 			avma = ctop;
 		}
 
+		if (setup->stats) {
+			state_stats_t *stats = &setup->stats->states[state];
+			stats->calls++;
+			stats->wall += stats_clock(CLOCK_MONOTONIC) - wall;
+			stats->cpu += stats_clock(CLOCK_THREAD_CPUTIME_ID) - cpu;
+			if (timeout) stats->timeouts++;
+			if (rejected) stats->rejections++;
+			if (diff <= 0) stats->backtracks++;
+		}
+
 		int new_state = state + diff;
 		if (new_state < start_offset) new_state = start_offset;
 
@@ -378,6 +434,9 @@ int exhaustive_gen_retry(curve_t *curve, const exhaustive_t *setup,
 
 	verbose_log("\n");
 
+	if (setup->stats) {
+		setup->stats->curves++;
+	}
 	return 1;
 }
 
@@ -399,10 +458,46 @@ static void exhaustive_quit(exhaustive_t *setup) {
 	exhaustive_clear(setup);
 }
 
-int exhaustive_generate(exhaustive_t *setup) {
-	output_o_begin();
+/**
+ * @brief Whether the curves can be generated in parallel, which is not the
+ * case if some generator reads from the input.
+ * @param setup
+ * @return
+ */
+static bool exhaustive_threadable(const exhaustive_t *setup) {
+	const gen_f input_gens[] = {&ansi_gen_seed_input,
+	                            &brainpool_gen_seed_input,
+	                            &brainpool_rfc_gen_seed_input,
+	                            &field_gen_input,
+	                            &field_gen_once,
+	                            &a_gen_input,
+	                            &a_gen_once,
+	                            &b_gen_input,
+	                            &b_gen_once,
+	                            &order_gen_input};
+	size_t ninput = sizeof(input_gens) / sizeof(gen_f);
+	for (size_t i = 0; i < OFFSET_END; ++i) {
+		for (size_t j = 0; j < ninput; ++j) {
+			if (setup->generators[i] == input_gens[j]) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+static void exhaustive_checkpoint(unsigned long emitted) {
+	if (cfg->checkpoint) {
+		checkpoint_save(emitted);
+	}
+}
+
+static int exhaustive_generate_single(exhaustive_t *setup,
+                                      unsigned long emitted) {
 	int result = EXIT_SUCCESS;
-	for (unsigned long i = 0; i < cfg->count; ++i) {
+	for (unsigned long i = emitted; i < cfg->count; ++i) {
+		// curve i gets the same stream as in a threaded run
+		random_stream(i + 1);
 		debug_log_start("Generating new curve");
 		curve_t *curve = curve_new();
 		if (!exhaustive_gen(curve, setup, OFFSET_SEED, OFFSET_END)) {
@@ -412,14 +507,196 @@ int exhaustive_generate(exhaustive_t *setup) {
 		}
 		debug_log_end("Generated new curve");
 
-		output_o(curve);
-		if (i != cfg->count - 1) {
+		if (i) {
 			output_o_separator();
 		}
+		output_o(curve);
 		curve_free(&curve);
+		exhaustive_checkpoint(i + 1);
+	}
+	return result;
+}
+
+static void exhaustive_write(exhaustive_result_t *result,
+                             unsigned long *emitted) {
+	if (*emitted) {
+		output_o_separator();
+	}
+	output_o_raw(result->output);
+	(*emitted)++;
+	try_free(result->output);
+	try_free(result);
+	exhaustive_checkpoint(*emitted);
+}
+
+static int exhaustive_generate_threaded(exhaustive_t *setup,
+                                        unsigned long emitted) {
+	pthread_t pthreads[cfg->threads];
+	exhaustive_thread_t threads[cfg->threads];
+	struct pari_thread pari_threads[cfg->threads];
+
+	unsigned long count = (unsigned long)cfg->count - emitted;
+	unsigned long claimed = 0;
+	unsigned long running = cfg->threads;
+	bool stop = false;
+	atomic_bool *done = try_calloc(sizeof(atomic_bool) * count);
+	unsigned long *racers = try_calloc(sizeof(unsigned long) * count);
+	for (unsigned long i = 0; i < count; ++i) {
+		atomic_init(&done[i], false);
+	}
+	pthread_mutex_t state_mutex = PTHREAD_MUTEX_INITIALIZER;
+	queue_t *results = queue_new(cfg->threads * 2);
+
+	for (size_t i = 0; i < cfg->threads; ++i) {
+		pari_thread_alloc(&pari_threads[i], cfg->thread_memory,
+		                  (GEN)&threads[i]);
+		threads[i].stats = (stats_t){0};
+
+		threads[i].pari_thread = &pari_threads[i];
+		threads[i].setup = setup;
+		threads[i].count = count;
+		threads[i].claimed = &claimed;
+		threads[i].done = done;
+		threads[i].racers = racers;
+		threads[i].running = &running;
+		threads[i].race = !cfg->rng_seed;
+		threads[i].first = emitted;
+		threads[i].stop = &stop;
+		threads[i].mutex_state = &state_mutex;
+		threads[i].results = results;
+	}
+
+	for (size_t i = 0; i < cfg->threads; ++i) {
+		pthread_create(&pthreads[i], NULL, &exhaustive_thread,
+		               (void *)&threads[i]);
+	}
+
+	/*
+	 * This thread is the writer, it receives at most one result per index,
+	 * until the last worker exits and closes the queue. With ordered output,
+	 * results that arrive early are held back until all the preceding ones
+	 * are written.
+	 */
+	exhaustive_result_t **pending = NULL;
+	if (cfg->ordered) {
+		pending = try_calloc(sizeof(exhaustive_result_t *) * count);
+	}
+	int status = EXIT_SUCCESS;
+	unsigned long written = 0;
+	exhaustive_result_t *result;
+	while ((result = queue_pop(results))) {
+		if (!result->output) {
+			/* stop handing out work and cancel whatever is being generated */
+			pthread_mutex_lock(&state_mutex);
+			stop = true;
+			for (unsigned long i = 0; i < count; ++i) {
+				atomic_store(&done[i], true);
+			}
+			pthread_mutex_unlock(&state_mutex);
+			status = EXIT_FAILURE;
+			try_free(result);
+			continue;
+		}
+
+		if (cfg->ordered) {
+			pending[result->index] = result;
+			while (written < count && pending[written]) {
+				exhaustive_result_t *next = pending[written];
+				pending[written++] = NULL;
+				exhaustive_write(next, &emitted);
+			}
+		} else {
+			exhaustive_write(result, &emitted);
+		}
+	}
+
+	for (size_t i = 0; i < cfg->threads; ++i) {
+		pthread_join(pthreads[i], NULL);
+		if (setup->stats) {
+			stats_merge(setup->stats, &threads[i].stats);
+		}
+	}
+
+	if (pending) {
+		/* after a failure, some later curves might not have been written */
+		for (unsigned long i = 0; i < count; ++i) {
+			if (pending[i]) {
+				try_free(pending[i]->output);
+				try_free(pending[i]);
+			}
+		}
+		try_free(pending);
+	}
+	for (size_t i = 0; i < cfg->threads; ++i) {
+		pari_thread_free(&pari_threads[i]);
+	}
+	try_free(done);
+	try_free(racers);
+	pthread_mutex_destroy(&state_mutex);
+	queue_free(&results);
+
+	return status;
+}
+
+int exhaustive_generate(exhaustive_t *setup) {
+	unsigned long emitted = 0;
+	if (cfg->resume) {
+		checkpoint_t checkpoint = {0};
+		bool restored =
+		    checkpoint_load(&checkpoint) && checkpoint_restore(&checkpoint);
+		emitted = checkpoint.emitted;
+		checkpoint_free(&checkpoint);
+		if (!restored) {
+			return EXIT_FAILURE;
+		}
+		verbose_log("Resuming after %lu curves.\n", emitted);
+	}
+
+	stats_t stats = {0};
+	double wall = 0, cpu = 0;
+	if (cfg->stats) {
+		setup->stats = &stats;
+		wall = stats_clock(CLOCK_MONOTONIC);
+		cpu = stats_clock(CLOCK_PROCESS_CPUTIME_ID);
+	}
+
+	if (!cfg->resume) {
+		output_o_begin();
+		exhaustive_checkpoint(0);
+	}
+	int result;
+	if (emitted >= (unsigned long)cfg->count) {
+		result = EXIT_SUCCESS;
+	} else if (cfg->threads > 1 && exhaustive_threadable(setup)) {
+		result = exhaustive_generate_threaded(setup, emitted);
+	} else {
+		if (cfg->threads > 1) {
+			verbose_log(
+			    "Parameters are read from input, generating in a single "
+			    "thread.\n");
+		}
+		result = exhaustive_generate_single(setup, emitted);
+	}
+	if (timeout_expired()) {
+		// the curves done so far are the result, the run did not fail
+		verbose_log("Deadline reached, stopping.\n");
+		result = EXIT_SUCCESS;
 	}
 	output_o_end();
 
+	if (cfg->prefilter) {
+		unsigned long tested, rejected;
+		curve_torsion_stats(&tested, &rejected);
+		verbose_log("Pre-filter rejected %lu of %lu curves (%.1f%%).\n",
+		            rejected, tested,
+		            tested ? 100.0 * rejected / tested : 0.0);
+	}
+	if (cfg->stats) {
+		stats_write(&stats, stats_clock(CLOCK_MONOTONIC) - wall,
+		            stats_clock(CLOCK_PROCESS_CPUTIME_ID) - cpu);
+		setup->stats = NULL;
+	}
+
 	return result;
 }
 
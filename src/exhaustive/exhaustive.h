@@ -8,10 +8,14 @@
 #ifndef ECGEN_EXHAUSTIVE_EXHAUSTIVE_H
 #define ECGEN_EXHAUSTIVE_EXHAUSTIVE_H
 
+#include <stdatomic.h>
 #include "misc/types.h"
+#include "stats.h"
 
 /**
  * @brief
+ * @param cancel if set, generation is abandoned once this becomes true
+ * @param stats if set, per state counters and timings are added to it
  */
 typedef struct {
 	gen_f *generators;
@@ -19,6 +23,8 @@ typedef struct {
 	check_t **validators;
 	arg_t **check_argss;
 	unroll_f *unrolls;
+	const atomic_bool *cancel;
+	stats_t *stats;
 } exhaustive_t;
 
 /**
@@ -39,7 +45,7 @@ void exhaustive_uinit(unroll_f *unrolls);
  * @param start_offset
  * @param end_offset
  * @param retry
- * @return
+ * @return 0 on failure or when cancelled through setup->cancel
  */
 int exhaustive_gen_retry(curve_t *curve, const exhaustive_t *setup,
                          offset_e start_offset, offset_e end_offset, int retry);
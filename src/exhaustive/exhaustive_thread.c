@@ -0,0 +1,99 @@
+/*
+ * ecgen, tool for generating Elliptic curve domain parameters
+ * Copyright (C) 2017-2018 J08nY
+ */
+
+#include "exhaustive_thread.h"
+#include "io/output.h"
+#include "obj/curve.h"
+#include "util/memory.h"
+#include "util/random.h"
+#include "util/timeout.h"
+
+bool exhaustive_thread_claim(exhaustive_thread_t *thread,
+                             unsigned long *index) {
+	bool result = false;
+	pthread_mutex_lock(thread->mutex_state);
+	if (!*thread->stop) {
+		if (*thread->claimed < thread->count) {
+			*index = (*thread->claimed)++;
+			result = true;
+		} else if (thread->race) {
+			for (unsigned long i = 0; i < thread->count; ++i) {
+				if (atomic_load(&thread->done[i])) continue;
+				if (!result || thread->racers[i] < thread->racers[*index]) {
+					*index = i;
+					result = true;
+				}
+			}
+		}
+		if (result) {
+			thread->racers[*index]++;
+		}
+	}
+	pthread_mutex_unlock(thread->mutex_state);
+	return result;
+}
+
+bool exhaustive_thread_finish(exhaustive_thread_t *thread, unsigned long index,
+                              bool success) {
+	pthread_mutex_lock(thread->mutex_state);
+	thread->racers[index]--;
+	bool result = !atomic_load(&thread->done[index]);
+	if (result && success) {
+		atomic_store(&thread->done[index], true);
+	}
+	pthread_mutex_unlock(thread->mutex_state);
+	return result;
+}
+
+void *exhaustive_thread(void *arg) {
+	exhaustive_thread_t *thread = (exhaustive_thread_t *)arg;
+	pari_thread_start(thread->pari_thread);
+	random_init();
+	timeout_thread_init();
+
+	exhaustive_t setup = *thread->setup;
+	if (setup.stats) {
+		setup.stats = &thread->stats;
+	}
+	unsigned long index;
+	while (exhaustive_thread_claim(thread, &index)) {
+		pari_sp ltop = avma;
+		setup.cancel = &thread->done[index];
+		random_stream(thread->first + index + 1);
+
+		debug_log_start("Generating new curve");
+		char *output = NULL;
+		curve_t *curve = curve_new();
+		if (exhaustive_gen(curve, &setup, OFFSET_SEED, OFFSET_END)) {
+			debug_log_end("Generated new curve");
+			/* serialize here, so that the writer only ever touches strings */
+			output = output_s(curve);
+		}
+		curve_free(&curve);
+		avma = ltop;
+
+		bool failed = output == NULL;
+		if (!exhaustive_thread_finish(thread, index, !failed)) {
+			/* lost the race, or the writer stopped everything */
+			try_free(output);
+			continue;
+		}
+		exhaustive_result_t *result = try_calloc(sizeof(exhaustive_result_t));
+		result->index = index;
+		result->output = output;
+		queue_push(thread->results, result);
+		if (failed) break;
+	}
+
+	pthread_mutex_lock(thread->mutex_state);
+	if (--*thread->running == 0) {
+		queue_close(thread->results);
+	}
+	pthread_mutex_unlock(thread->mutex_state);
+
+	pari_thread_close();
+	timeout_thread_quit();
+	return NULL;
+}
@@ -0,0 +1,87 @@
+/*
+ * ecgen, tool for generating Elliptic curve domain parameters
+ * Copyright (C) 2017-2018 J08nY
+ */
+/**
+ * @file exhaustive_thread.h
+ */
+#ifndef ECGEN_EXHAUSTIVE_EXHAUSTIVE_THREAD_H
+#define ECGEN_EXHAUSTIVE_EXHAUSTIVE_THREAD_H
+
+#include <pthread.h>
+#include "exhaustive.h"
+#include "misc/types.h"
+#include "util/queue.h"
+
+/**
+ * @brief A generated curve, passed from a worker thread to the writer.
+ * @param index which of the cfg->count curves this is
+ * @param output the curve serialized by output_s, NULL if generation failed
+ */
+typedef struct {
+	unsigned long index;
+	char *output;
+} exhaustive_result_t;
+
+/**
+ * @brief Shared state of the worker threads.
+ *
+ * Once every index has been claimed, idle workers race on the curves that
+ * are still being generated: the first to finish publishes its curve and
+ * the others are cancelled through done[index].
+ *
+ * @param done per index, set once a curve for it was published
+ * @param racers per index, how many workers are generating it
+ * @param running how many workers have not exited yet
+ * @param race whether to race on unfinished curves, which is disabled when
+ * every curve comes from its own reproducible random stream
+ * @param first the number of the first curve to generate, when resuming
+ * @param stats this worker's statistics, if the setup collects them
+ */
+typedef struct {
+	struct pari_thread *pari_thread;
+	const exhaustive_t *setup;
+	unsigned long count;
+	unsigned long *claimed;
+	atomic_bool *done;
+	unsigned long *racers;
+	unsigned long *running;
+	bool race;
+	unsigned long first;
+	bool *stop;
+	pthread_mutex_t *mutex_state;
+	queue_t *results;
+	stats_t stats;
+} exhaustive_thread_t;
+
+/**
+ * @brief Claim the index of the next curve to generate.
+ *
+ * Unclaimed indices are handed out first, after that the unfinished index
+ * with the fewest racers.
+ *
+ * @param thread
+ * @param index where to store the claimed index
+ * @return whether an index was claimed, false if there is nothing left to do
+ */
+bool exhaustive_thread_claim(exhaustive_thread_t *thread, unsigned long *index);
+
+/**
+ * @brief Finish an attempt at generating the curve at index.
+ * @param thread
+ * @param index
+ * @param success whether the attempt produced a curve
+ * @return whether the result should be passed to the writer, false if the
+ * attempt lost the race or was cancelled
+ */
+bool exhaustive_thread_finish(exhaustive_thread_t *thread, unsigned long index,
+                              bool success);
+
+/**
+ *
+ * @param arg
+ * @return
+ */
+void *exhaustive_thread(void *arg);
+
+#endif  // ECGEN_EXHAUSTIVE_EXHAUSTIVE_THREAD_H
@@ -0,0 +1,83 @@
+/*
+ * ecgen, tool for generating Elliptic curve domain parameters
+ * Copyright (C) 2017-2018 J08nY
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include "stats.h"
+#include <ctype.h>
+#include <parson/parson.h>
+#include "io/output.h"
+#include "misc/config.h"
+#include "util/memory.h"
+
+double stats_clock(clockid_t clock) {
+	struct timespec ts;
+	clock_gettime(clock, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+void stats_merge(stats_t *to, const stats_t *from) {
+	to->curves += from->curves;
+	for (size_t i = 0; i < OFFSET_END; ++i) {
+		to->states[i].calls += from->states[i].calls;
+		to->states[i].rejections += from->states[i].rejections;
+		to->states[i].backtracks += from->states[i].backtracks;
+		to->states[i].timeouts += from->states[i].timeouts;
+		to->states[i].wall += from->states[i].wall;
+		to->states[i].cpu += from->states[i].cpu;
+	}
+}
+
+char *stats_json(const stats_t *stats, double wall, double cpu) {
+	JSON_Value *root_value = json_value_init_object();
+	JSON_Object *root_object = json_value_get_object(root_value);
+
+	json_object_set_number(root_object, "curves", stats->curves);
+	json_object_set_number(root_object, "wall", wall);
+	json_object_set_number(root_object, "cpu", cpu);
+
+	JSON_Value *states_value = json_value_init_object();
+	JSON_Object *states_object = json_value_get_object(states_value);
+	for (size_t i = 0; i < OFFSET_END; ++i) {
+		const state_stats_t *state = &stats->states[i];
+		JSON_Value *state_value = json_value_init_object();
+		JSON_Object *state_object = json_value_get_object(state_value);
+		json_object_set_number(state_object, "calls", state->calls);
+		json_object_set_number(state_object, "rejections", state->rejections);
+		json_object_set_number(state_object, "backtracks", state->backtracks);
+		json_object_set_number(state_object, "timeouts", state->timeouts);
+		json_object_set_number(state_object, "wall", state->wall);
+		json_object_set_number(state_object, "cpu", state->cpu);
+
+		char name[16] = {0};
+		for (size_t j = 0; offset_s[i][j] && j < sizeof(name) - 1; ++j) {
+			name[j] = (char)tolower(offset_s[i][j]);
+		}
+		json_object_set_value(states_object, name, state_value);
+	}
+	json_object_set_value(root_object, "states", states_value);
+
+	char *result = json_serialize_to_string_pretty(root_value);
+	json_value_free(root_value);
+	return result;
+}
+
+void stats_write(const stats_t *stats, double wall, double cpu) {
+	FILE *stream = verbose;
+	if (cfg->stats_file) {
+		stream = fopen(cfg->stats_file, "w");
+		if (!stream) {
+			perror("Failed to open stats file.");
+			return;
+		}
+	}
+
+	char *json = stats_json(stats, wall, cpu);
+	fprintf(stream, "%s\n", json);
+	try_free(json);
+
+	if (cfg->stats_file) {
+		fclose(stream);
+	}
+}
@@ -0,0 +1,77 @@
+/*
+ * ecgen, tool for generating Elliptic curve domain parameters
+ * Copyright (C) 2017-2018 J08nY
+ */
+/**
+ * @file stats.h
+ */
+#ifndef ECGEN_EXHAUSTIVE_STATS_H
+#define ECGEN_EXHAUSTIVE_STATS_H
+
+#include <stdio.h>
+#include <time.h>
+#include "misc/types.h"
+
+/**
+ * @brief Counters and timings of one state of the exhaustive state machine.
+ * @param calls how many times the generator was called
+ * @param rejections how many times a validator rejected the generated value
+ * @param backtracks how many times the state went back, after a failed
+ * generator, a rejection or a timeout
+ * @param timeouts how many times the generator timed out
+ * @param wall wall-clock seconds spent in the generator and validators
+ * @param cpu thread CPU seconds spent in the generator and validators
+ */
+typedef struct {
+	unsigned long calls;
+	unsigned long rejections;
+	unsigned long backtracks;
+	unsigned long timeouts;
+	double wall;
+	double cpu;
+} state_stats_t;
+
+/**
+ * @brief Statistics of an exhaustive run.
+ * @param curves how many curves were generated
+ * @param states per offset_e state
+ */
+typedef struct {
+	unsigned long curves;
+	state_stats_t states[OFFSET_END];
+} stats_t;
+
+/**
+ * @brief Read a clock in seconds.
+ * @param clock CLOCK_MONOTONIC, CLOCK_THREAD_CPUTIME_ID, ...
+ * @return
+ */
+double stats_clock(clockid_t clock);
+
+/**
+ * @brief Add the counters and timings of <code>from</code> to
+ * <code>to</code>.
+ * @param to
+ * @param from
+ */
+void stats_merge(stats_t *to, const stats_t *from);
+
+/**
+ * @brief Serialize the statistics into a JSON object.
+ * @param stats
+ * @param wall wall-clock seconds of the whole run
+ * @param cpu process CPU seconds of the whole run
+ * @return a JSON string, should be freed with try_free
+ */
+char *stats_json(const stats_t *stats, double wall, double cpu);
+
+/**
+ * @brief Write the statistics as JSON to cfg->stats_file, or the verbose
+ * output if not set.
+ * @param stats
+ * @param wall wall-clock seconds of the whole run
+ * @param cpu process CPU seconds of the whole run
+ */
+void stats_write(const stats_t *stats, double wall, double cpu);
+
+#endif  // ECGEN_EXHAUSTIVE_STATS_H
@@ -3,26 +3,38 @@
  * Copyright (C) 2017-2018 J08nY
  */
 #include "curve.h"
+#include <stdatomic.h>
+#include "exhaustive/arg.h"
+#include "math/torsion.h"
 #include "math/twists.h"
+#include "order.h"
 
-GENERATOR(curve_gen_any) {
-	pari_sp ltop = avma;
+static atomic_ulong torsion_tested = ATOMIC_VAR_INIT(0);
+static atomic_ulong torsion_rejected = ATOMIC_VAR_INIT(0);
+
+static GEN curve_coefficients(GEN field, GEN a, GEN b) {
 	GEN v = gen_0;
-	switch (typ(curve->field)) {
+	switch (typ(field)) {
 		case t_INT:
 			v = gtovec0(gen_0, 2);
-			gel(v, 1) = curve->a;
-			gel(v, 2) = curve->b;
+			gel(v, 1) = a;
+			gel(v, 2) = b;
 			break;
 		case t_FFELT:
 			v = gtovec0(gen_0, 5);
 			gel(v, 1) = gen_1;
-			gel(v, 2) = curve->a;
-			gel(v, 5) = curve->b;
+			gel(v, 2) = a;
+			gel(v, 5) = b;
 			break;
 		default:
-			pari_err_TYPE("curve_gen_any", curve->field);
+			pari_err_TYPE("curve_gen_any", field);
 	}
+	return v;
+}
+
+GENERATOR(curve_gen_any) {
+	pari_sp ltop = avma;
+	GEN v = curve_coefficients(curve->field, curve->a, curve->b);
 	GEN crv = ellinit(v, curve->field, -1);
 
 	if (glength(crv) == 0) {
@@ -34,6 +46,134 @@ GENERATOR(curve_gen_any) {
 	}
 }
 
+/*
+ * The F_p specific entry of the ell structure, as ellinit computes it: the
+ * short model [-27 c4, -54 c6] and the change of variables [6, 3 b2, 3 a1,
+ * 108 a3] to it. Only -54 c6 depends on a6.
+ */
+static GEN curve_template_fp(GEN crv, GEN p) {
+	GEN a1 = Rg_to_Fp(gel(crv, 1), p), a3 = Rg_to_Fp(gel(crv, 3), p);
+	GEN b2 = Rg_to_Fp(gel(crv, 6), p);
+	GEN c4 = Rg_to_Fp(gel(crv, 10), p), c6 = Rg_to_Fp(gel(crv, 11), p);
+	GEN a4 = Fp_neg(Fp_mulu(c4, 27, p), p);
+	GEN a6 = Fp_neg(Fp_mulu(c6, 54, p), p);
+	GEN change = mkvec4(utoi(6), Fp_mulu(b2, 3, p), Fp_mulu(a1, 3, p),
+	                    Fp_mulu(a3, 108, p));
+	return mkvec2(p, mkvec3(a4, a6, change));
+}
+
+/*
+ * Build the ell structure of the template curve with a6 = b. Only the a6
+ * dependent entries are computed, the rest is shared with the template,
+ * except for the cache of the curve, which is its last entry. Returns NULL
+ * for a singular curve, or an ell structure without the expected layout.
+ */
+static GEN curve_template_build(GEN template, GEN b) {
+	pari_sp ltop = avma;
+	GEN t = gel(template, 1);
+	// the F_p entry 15 and the cache after it have to be there
+	long l = lg(t);
+	if (l < 17 || typ(gel(t, 15)) != t_VEC || lg(gel(t, 15)) < 2) {
+		return NULL;
+	}
+	GEN a1 = gel(t, 1), a2 = gel(t, 2), a3 = gel(t, 3), a4 = gel(t, 4);
+	GEN b2 = gel(t, 6), b4 = gel(t, 7), c4 = gel(t, 10);
+
+	GEN a6 = gmul(b, gel(template, 2));
+	GEN b6 = gadd(gsqr(a3), gmulsg(4, a6));
+	GEN b8 = gadd(gsub(gadd(gmul(gsqr(a1), a6), gmulsg(4, gmul(a2, a6))),
+	                   gmul(gmul(a1, a3), a4)),
+	              gsub(gmul(a2, gsqr(a3)), gsqr(a4)));
+	GEN c6 = gadd(gsub(gmulsg(36, gmul(b2, b4)), gpowgs(b2, 3)),
+	              gmulsg(-216, b6));
+	GEN disc = gadd(gsub(gneg(gmul(gsqr(b2), b8)), gmulsg(8, gpowgs(b4, 3))),
+	                gsub(gmulsg(9, gmul(gmul(b2, b4), b6)),
+	                     gmulsg(27, gsqr(b6))));
+	if (gequal0(disc)) {
+		avma = ltop;
+		return NULL;
+	}
+	GEN j = gdiv(gpowgs(c4, 3), disc);
+	gerepileall(ltop, 6, &a6, &b6, &b8, &c6, &disc, &j);
+
+	GEN crv = cgetg(l, typ(t));
+	for (long i = 1; i < l - 1; ++i) {
+		gel(crv, i) = gel(t, i);
+	}
+	gel(crv, 5) = a6;
+	gel(crv, 8) = b6;
+	gel(crv, 9) = b8;
+	gel(crv, 11) = c6;
+	gel(crv, 12) = disc;
+	gel(crv, 13) = j;
+	gel(crv, 15) = curve_template_fp(crv, gel(gel(t, 15), 1));
+	gel(crv, l - 1) = gcopy(gel(t, l - 1));
+	return crv;
+}
+
+GEN curve_template_new(const curve_t *curve) {
+	// only the F_p specific entry of the ell structure is rebuilt
+	if (typ(curve->field) != t_INT) {
+		return NULL;
+	}
+	pari_sp ltop = avma;
+	GEN one = mkintmod(gen_1, curve->field);
+
+	// find two nonsingular curves, one is the template, the other checks it
+	GEN crvs[2] = {NULL, NULL};
+	GEN bs[2] = {NULL, NULL};
+	size_t found = 0;
+	for (long i = 1; i < 64 && found < 2; ++i) {
+		GEN b = stoi(i);
+		GEN v = curve_coefficients(curve->field, curve->a, b);
+		GEN crv = ellinit(v, curve->field, -1);
+		if (glength(crv) != 0) {
+			crvs[found] = crv;
+			bs[found] = b;
+			found++;
+		}
+	}
+	if (found < 2) {
+		avma = ltop;
+		return NULL;
+	}
+
+	GEN template = mkvec2(crvs[0], one);
+	GEN built = curve_template_build(template, bs[1]);
+	// everything but the cache has to be what ellinit gives
+	bool same = built && lg(built) == lg(crvs[1]);
+	for (long i = 1; same && i < lg(built) - 1; ++i) {
+		same = gidentical(gel(built, i), gel(crvs[1], i));
+	}
+	if (!same) {
+		// the ell structure is not what the template expects
+		avma = ltop;
+		return NULL;
+	}
+	GEN result = gclone(template);
+	avma = ltop;
+	return result;
+}
+
+void curve_template_free(GEN *template) {
+	if (*template) {
+		gunclone(*template);
+		*template = NULL;
+	}
+}
+
+GENERATOR(curve_gen_template) {
+	HAS_ARG(args);
+	pari_sp ltop = avma;
+	GEN crv = curve_template_build((GEN)args->args, curve->b);
+	if (!crv) {
+		avma = ltop;
+		return -3;
+	}
+	curve->curve = crv;
+	return 1;
+}
+
 GENERATOR(curve_gen_any_twist) {
 	int result = curve_gen_any(curve, args, state);
 	if (result != 1) {
@@ -52,7 +192,36 @@ CHECK(curve_check_nonzero) {
 	}
 }
 
+CHECK(curve_check_torsion) {
+	HAS_ARG(args);
+	if (cfg->field == FIELD_BINARY) return 1;
+	pari_ulong bound = *(pari_ulong *)args->args;
+	pari_ulong cofactor = cfg->cofactor ? (pari_ulong)cfg->cofactor_value : 1;
+
+	atomic_fetch_add(&torsion_tested, 1);
+	forprime_t primes;
+	u_forprime_init(&primes, 2, bound);
+	pari_ulong l;
+	while ((l = u_forprime_next(&primes))) {
+		if (cofactor % l == 0) continue;
+		// the order could be equal to cofactor * l on tiny fields
+		if (cmpiu(curve->field, 4 * cofactor * l) <= 0) break;
+		if (torsion_divides(curve, l)) {
+			atomic_fetch_add(&torsion_rejected, 1);
+			return -3;
+		}
+	}
+	return 1;
+}
+
+void curve_torsion_stats(unsigned long *tested, unsigned long *rejected) {
+	*tested = atomic_load(&torsion_tested);
+	*rejected = atomic_load(&torsion_rejected);
+}
+
 UNROLL(curve_unroll) {
+	// the order goes with the curve
+	order_factors_free(curve);
 	if (curve->curve) {
 		obj_free(curve->curve);
 		curve->curve = NULL;
@@ -33,6 +33,38 @@ GENERATOR(curve_gen_any);
  */
 GENERATOR(curve_gen_any_twist);
 
+/**
+ * @brief Prepare a template for building curves that share the field and a
+ * with <code>curve</code>, and only differ in b.
+ *
+ * Only prime fields get a template. It is checked against a curve built by
+ * ellinit, if the ell structure does not match what the template expects,
+ * NULL is returned and curve_gen_any should be used instead.
+ * @param curve a curve with the field and a set
+ * @return the template as a clone, or NULL
+ */
+GEN curve_template_new(const curve_t *curve);
+
+/**
+ * @brief Free a template from curve_template_new.
+ * @param template
+ */
+void curve_template_free(GEN *template);
+
+/**
+ * GENERATOR(gen_f)
+ * Creates a curve GEN in curve_t curve from b and a template, which gives the
+ * field and a. Only the parts of the curve that depend on b are computed,
+ * the rest is shared with the template, so the template has to outlive the
+ * curve.
+ *
+ * @param curve A curve_t being generated
+ * @param args GEN template from curve_template_new
+ * @param state
+ * @return state diff
+ */
+GENERATOR(curve_gen_template);
+
 /**
  * CHECK(check_f)
  * Checks that the curve has non-zero discriminant.
@@ -43,6 +75,25 @@ GENERATOR(curve_gen_any_twist);
  */
 CHECK(curve_check_nonzero);
 
+/**
+ * CHECK(check_f)
+ * Checks that no small prime l, up to a bound, divides the curve order,
+ * without computing it. Primes dividing the cofactor are skipped. Only
+ * applies to prime field curves.
+ *
+ * @param curve
+ * @param args pari_ulong bound on l
+ * @return
+ */
+CHECK(curve_check_torsion);
+
+/**
+ * @brief Get the number of curves tested and rejected by curve_check_torsion.
+ * @param tested
+ * @param rejected
+ */
+void curve_torsion_stats(unsigned long *tested, unsigned long *rejected);
+
 /**
  *
  * @param curve
@@ -121,4 +121,8 @@ void equation_quit(void) {
 	if (b && isclone(b)) {
 		gunclone(b);
 	}
+	a = NULL;
+	curve_a = NULL;
+	b = NULL;
+	curve_b = NULL;
 }
@@ -182,4 +182,6 @@ void field_quit(void) {
 	if (field && isclone(field)) {
 		gunclone(field);
 	}
+	field = NULL;
+	curve_field = NULL;
 }
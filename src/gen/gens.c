@@ -7,13 +7,15 @@
 #include "math/subgroup.h"
 #include "obj/point.h"
 #include "obj/subgroup.h"
+#include "order.h"
 
-static subgroup_t *gens_point(GEN point, const curve_t *curve) {
+static subgroup_t *gens_point(GEN point, curve_t *curve) {
 	subgroup_t *sub = subgroup_new();
 	point_t *p = point_new();
 	sub->generator = p;
 	p->point = gcopy(point);
-	p->order = ellorder(curve->curve, p->point, NULL);
+	p->order = ellorder(curve->curve, p->point,
+	                    mkvec2(curve->order, order_factors(curve)));
 	p->cofactor = divii(curve->order, p->order);
 	return sub;
 }
@@ -53,10 +55,11 @@ GENERATOR(gens_gen_cofactor) {
 
 	GEN generators = ellff_get_gens(curve->curve);
 	long len = glength(generators);
+	GEN o = mkvec2(curve->order, order_factors(curve));
 	point_t *p = NULL;
 	for (long i = 1; i <= len; ++i) {
 		GEN gen = gel(generators, i);
-		GEN gen_order = ellorder(curve->curve, gen, NULL);
+		GEN gen_order = ellorder(curve->curve, gen, o);
 
 		if (equalii(order, gen_order)) {
 			p = point_new();
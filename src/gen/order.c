@@ -97,6 +97,22 @@ GENERATOR(order_gen_koblitz) {
 	return 1;
 }
 
+GEN order_factors(curve_t *curve) {
+	if (!curve->factors) {
+		pari_sp ltop = avma;
+		curve->factors = gclone(Z_factor(curve->order));
+		avma = ltop;
+	}
+	return curve->factors;
+}
+
+void order_factors_free(curve_t *curve) {
+	if (curve->factors) {
+		gunclone(curve->factors);
+		curve->factors = NULL;
+	}
+}
+
 CHECK(order_check_pohlig_hellman) {
 	HAS_ARG(args);
 	pari_sp ltop = avma;
@@ -104,8 +120,7 @@ CHECK(order_check_pohlig_hellman) {
 	const char *min_fact = args->args;
 	GEN minf = strtoi(min_fact);
 
-	GEN factors = factor(curve->order);
-	GEN primes = gel(factors, 1);
+	GEN primes = gel(order_factors(curve), 1);
 
 	long len = glength(primes);
 	if (mpcmp(gel(primes, len), minf) <= 0) {
@@ -135,4 +150,11 @@ CHECK(order_check_discriminant) {
 	}
 	avma = ltop;
 	return 1;
-}
\ No newline at end of file
+}
+
+UNROLL(order_unroll) {
+	order_factors_free(curve);
+	// the order lives on the stack that is being unrolled
+	curve->order = NULL;
+	return -1;
+}
@@ -77,6 +77,20 @@ GENERATOR(order_gen_prime);
  */
 GENERATOR(order_gen_koblitz);
 
+/**
+ * @brief The factorization of the curve order, computed once and kept with
+ * the curve until its order changes.
+ * @param curve a curve_t with the order set
+ * @return a t_MAT, the factorization
+ */
+GEN order_factors(curve_t *curve);
+
+/**
+ * @brief Forget the factorization of the curve order, when it changes.
+ * @param curve
+ */
+void order_factors_free(curve_t *curve);
+
 /**
  *
  * @param curve
@@ -95,4 +109,14 @@ CHECK(order_check_pohlig_hellman);
  */
 CHECK(order_check_discriminant);
 
+/**
+ * UNROLL(unroll_f)
+ *
+ * @param curve
+ * @param from
+ * @param to
+ * @return
+ */
+UNROLL(order_unroll);
+
 #endif  // ECGEN_GEN_ORDER_H
@@ -6,8 +6,19 @@
 #include "exhaustive/arg.h"
 #include "math/subgroup.h"
 #include "obj/point.h"
+#include "order.h"
 #include "util/random.h"
 
+GEN point_factors(curve_t *curve, point_t *point) {
+	if (!point->factors) {
+		pari_sp ltop = avma;
+		point->factors =
+		    gclone(subgroups_factors(order_factors(curve), point->order));
+		avma = ltop;
+	}
+	return point->factors;
+}
+
 GENERATOR(point_gen_random) {
 	long which_gen = itos(random_range(gen_0, stoi(curve->ngens)));
 
@@ -16,7 +27,10 @@ GENERATOR(point_gen_random) {
 	GEN p = ellmul(curve->curve, subgroup->generator->point, mul);
 	point_t *point = point_new();
 	point->point = p;
-	point->order = ellorder(curve->curve, p, NULL);
+	point->order = ellorder(
+	    curve->curve, p,
+	    mkvec2(subgroup->generator->order,
+	           point_factors(curve, subgroup->generator)));
 	subgroup->npoints = 1;
 	subgroup->points = points_new(1);
 	subgroup->points[0] = point;
@@ -42,6 +56,8 @@ GENERATOR(points_gen_random) {
 		subgroup_t *subgroup = curve->generators[i];
 		subgroup->npoints = npoints_per_gen[i];
 		subgroup->points = points_new(npoints_per_gen[i]);
+		GEN o = mkvec2(subgroup->generator->order,
+		               point_factors(curve, subgroup->generator));
 
 		for (size_t j = 0; j < npoints_per_gen[i]; ++j) {
 			point_t *point = point_new();
@@ -53,7 +69,7 @@ GENERATOR(points_gen_random) {
 				GEN mul = random_range(gen_1, subgroup->generator->order);
 				GEN p = ellmul(curve->curve, subgroup->generator->point, mul);
 				point->point = p;
-				point->order = ellorder(curve->curve, p, NULL);
+				point->order = ellorder(curve->curve, p, o);
 			}
 			subgroup->points[j] = point;
 		}
@@ -61,29 +77,83 @@ GENERATOR(points_gen_random) {
 	return 1;
 }
 
+/**
+ * @brief The lcm of orders[lo..hi].
+ */
+static GEN points_lcm(GEN orders, long lo, long hi) {
+	GEN result = gel(orders, lo);
+	for (long i = lo + 1; i <= hi; ++i) {
+		result = lcmii(result, gel(orders, i));
+	}
+	return result;
+}
+
+/**
+ * @brief Walk the remainder tree over orders[lo..hi], point is of order
+ * dividing lcm, the lcm of those orders.
+ *
+ * Each half gets point multiplied by lcm / lcm(half), so the product shared
+ * by the orders in a half is multiplied once, not once per order.
+ */
+static void points_tree(GEN curve, GEN point, GEN lcm, GEN orders, long lo,
+                        long hi, GEN points) {
+	if (lo == hi) {
+		debug_log("VERIFY %Ps %Ps", gel(orders, lo),
+		          ellorder(curve, point, NULL));
+		gel(points, lo) = point;
+		return;
+	}
+	long mid = (lo + hi) / 2;
+	GEN left = points_lcm(orders, lo, mid);
+	GEN right = points_lcm(orders, mid + 1, hi);
+	GEN left_point = point;
+	if (!equalii(left, lcm)) {
+		left_point = ellmul(curve, point, diviiexact(lcm, left));
+	}
+	GEN right_point = point;
+	if (!equalii(right, lcm)) {
+		right_point = ellmul(curve, point, diviiexact(lcm, right));
+	}
+	points_tree(curve, left_point, left, orders, lo, mid, points);
+	points_tree(curve, right_point, right, orders, mid + 1, hi, points);
+}
+
 point_t **points_from_orders(GEN curve, point_t *generator, GEN orders) {
 	size_t norders = (size_t)glength(orders);
 	point_t **result = points_new(norders);
 
-	for (long i = 0; i < norders; ++i) {
-		pari_sp ftop = avma;
-		GEN num = gel(orders, i + 1);
-
-		GEN point = NULL;
-		if (equalii(generator->order, num)) {
-			point = gcopy(generator->point);
-		} else if (dvdii(generator->order, num)) {
-			GEN mul = divii(generator->order, num);
-			point = ellmul(curve, generator->point, mul);
+	pari_sp ltop = avma;
+	// only the orders that divide the generator order have a point
+	GEN which = cgetg(norders + 1, t_VECSMALL);
+	GEN dividing = cgetg(norders + 1, t_VEC);
+	long ndividing = 0;
+	for (long i = 1; i <= norders; ++i) {
+		GEN num = gel(orders, i);
+		if (dvdii(generator->order, num)) {
+			++ndividing;
+			which[ndividing] = i;
+			gel(dividing, ndividing) = num;
 		}
+	}
+	if (ndividing == 0) {
+		avma = ltop;
+		return result;
+	}
 
-		if (point) {
-			debug_log("VERIFY %Ps %Ps", num, ellorder(curve, point, NULL));
-			result[i] = point_new();
-			gerepileall(ftop, 1, &point);
-			result[i]->point = point;
-			result[i]->order = gcopy(num);
-		}
+	GEN lcm = points_lcm(dividing, 1, ndividing);
+	GEN point = generator->point;
+	if (!equalii(lcm, generator->order)) {
+		point = ellmul(curve, point, diviiexact(generator->order, lcm));
+	}
+	GEN points = cgetg(ndividing + 1, t_VEC);
+	points_tree(curve, point, lcm, dividing, 1, ndividing, points);
+	points = gerepilecopy(ltop, points);
+
+	for (long i = 1; i <= ndividing; ++i) {
+		point_t *p = point_new();
+		p->point = gel(points, i);
+		p->order = gcopy(gel(orders, which[i]));
+		result[which[i] - 1] = p;
 	}
 
 	return result;
@@ -135,33 +205,38 @@ GENERATOR(points_gen_trial) {
 
 GENERATOR(points_gen_prime) {
 	for (size_t i = 0; i < curve->ngens; ++i) {
-		GEN primes = subgroups_prime(curve->generators[i]->generator->order);
+		point_t *generator = curve->generators[i]->generator;
+		GEN primes = subgroups_prime(point_factors(curve, generator));
 		curve->generators[i]->npoints = (size_t)glength(primes);
 		curve->generators[i]->points = points_from_orders(
-		    curve->curve, curve->generators[i]->generator, primes);
+		    curve->curve, generator, primes);
 	}
 
 	return 1;
 }
 
 GENERATOR(points_gen_allgroups) {
+	size_t max = args ? *(size_t *)args->args : 0;
 	for (size_t i = 0; i < curve->ngens; ++i) {
-		GEN primes = subgroups_all(curve->generators[i]->generator->order);
+		point_t *generator = curve->generators[i]->generator;
+		GEN primes = subgroups_all(point_factors(curve, generator), max);
 		curve->generators[i]->npoints = (size_t)glength(primes);
 		curve->generators[i]->points = points_from_orders(
-		    curve->curve, curve->generators[i]->generator, primes);
+		    curve->curve, generator, primes);
 	}
 
 	return 1;
 }
 
 GENERATOR(points_gen_nonprime) {
+	size_t max = args ? *(size_t *)args->args : 0;
 	for (size_t i = 0; i < curve->ngens; ++i) {
-		GEN primes = subgroups_nonprime(curve->generators[i]->generator->order);
+		point_t *generator = curve->generators[i]->generator;
+		GEN primes = subgroups_nonprime(point_factors(curve, generator), max);
 		if (primes) {
 			curve->generators[i]->npoints = (size_t)glength(primes);
 			curve->generators[i]->points = points_from_orders(
-			    curve->curve, curve->generators[i]->generator, primes);
+			    curve->curve, generator, primes);
 		}
 	}
 
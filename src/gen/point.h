@@ -28,6 +28,15 @@ GENERATOR(point_gen_random);
  */
 GENERATOR(points_gen_random);
 
+/**
+ * @brief The factorization of the order of a point on the curve, derived
+ * from that of the curve order and kept with the point.
+ * @param curve a curve_t with the order set
+ * @param point a point_t with the order set
+ * @return a t_MAT, the factorization
+ */
+GEN point_factors(curve_t *curve, point_t *point);
+
 /**
  *
  * @param curve
@@ -69,7 +78,8 @@ GENERATOR(points_gen_prime);
  * Generates points on all subgroups of the curve. Prime and non-prime order.
  *
  * @param curve A curve_t being generated
- * @param args unused
+ * @param args size_t maximum number of points per generator, smallest orders
+ * first, or NULL for all
  * @return state diff
  */
 GENERATOR(points_gen_allgroups);
@@ -80,7 +90,8 @@ GENERATOR(points_gen_allgroups);
  * Generates points on non-prime order of the curve.
  *
  * @param curve A curve_t being generated
- * @param args unused
+ * @param args size_t maximum number of points per generator, smallest orders
+ * first, or NULL for all
  * @return state diff
  */
 GENERATOR(points_gen_nonprime);
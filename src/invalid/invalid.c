@@ -3,6 +3,7 @@
  * Copyright (C) 2017-2018 J08nY
  */
 #include "invalid.h"
+#include <string.h>
 #include "exhaustive/arg.h"
 #include "exhaustive/check.h"
 #include "exhaustive/exhaustive.h"
@@ -12,9 +13,16 @@
 #include "gen/gens.h"
 #include "gen/order.h"
 #include "gen/point.h"
+#include "io/input.h"
+#include "invalid_plan.h"
 #include "invalid_thread.h"
+#include "math/twists.h"
 #include "obj/curve.h"
 #include "util/memory.h"
+#include "util/timeout.h"
+
+/* The part of the --deadline left for generating points on a plan. */
+#define INVALID_PLAN_RESERVE 0.1
 
 static void invalid_original_ginit(gen_f *generators) {
 	generators[OFFSET_SEED] = &gen_skip;
@@ -115,9 +123,130 @@ static size_t invalid_primes(GEN order, pari_ulong **primes) {
 	return nprimes;
 }
 
-static size_t invalid_curves_single(const curve_t *curve, pari_ulong *primes,
-                                    size_t nprimes, curve_t **curves,
-                                    exhaustive_t *setup) {
+/**
+ * @brief Whether the i-th prime is covered by an invalid curve already.
+ */
+static bool invalid_done(const unsigned long *done, size_t i) {
+	return (done[i / BITS_IN_LONG] >> (i % BITS_IN_LONG)) & 1;
+}
+
+static void invalid_set_done(unsigned long *done, size_t i) {
+	done[i / BITS_IN_LONG] |= 1UL << (i % BITS_IN_LONG);
+}
+
+/**
+ * @brief Generate the points of a curve for the uncovered primes dividing its
+ * order, and output it once for each of them.
+ * @return how many primes the curve covers, 0 if it was not used
+ */
+static size_t invalid_harvest(curve_t *invalid, pari_ulong *primes,
+                              size_t nprimes, unsigned long *done,
+                              exhaustive_t *setup,
+                              exhaustive_t *invalid_setup) {
+	/*
+	 * does some small prime from our array divide the curve order?
+	 * if so how many?
+	 */
+	size_t total = 0;
+	for (size_t i = nprimes; i-- > 0;) {
+		if (!invalid_done(done, i) && dvdis(invalid->order, primes[i])) {
+			total++;
+		}
+	}
+	if (!total) {
+		return 0;
+	}
+	verbose_log("we have a new one, calculating prime order points.\n");
+
+	if (!exhaustive_gen_retry(invalid, setup, OFFSET_GENERATORS, OFFSET_POINTS,
+	                          1)) {
+		return 0;
+	}
+
+	/*
+	 * only pass small primes that divide the curve order and those
+	 * where we dont have a curve yet.
+	 * this is passed to points_gen_trial which uses trial division to
+	 * find
+	 * a point with given prime order.
+	 */
+	size_t j = 0;
+	pari_ulong dprimes[total];
+	for (size_t i = 0; i < nprimes; ++i) {
+		if (!invalid_done(done, i) && dvdis(invalid->order, primes[i])) {
+			verbose_log("prime %lu divides curve order.\n", primes[i]);
+			dprimes[j++] = primes[i];
+		}
+	}
+	arg_t prime_divisors = {dprimes, total};
+	invalid_setup->gen_argss[OFFSET_POINTS] = &prime_divisors;
+
+	/*
+	 * generate prime order points, this is expensive (order needs to be
+	 * factorised, so only do it if we want the curve)
+	 */
+	exhaustive_gen(invalid, invalid_setup, OFFSET_POINTS, OFFSET_END);
+	invalid_setup->gen_argss[OFFSET_POINTS] = NULL;
+
+	// output the curve for every prime it covers, then it can go
+	char *output = output_s(invalid);
+	for (size_t i = nprimes; i-- > 0;) {
+		if (!invalid_done(done, i) && dvdis(invalid->order, primes[i])) {
+			invalid_set_done(done, i);
+			output_o_separator();
+			output_o_raw(output);
+		}
+	}
+	try_free(output);
+
+	verbose_log("curve output: %lu primes from range divide order.\n",
+	            total);
+	return total;
+}
+
+/**
+ * @brief Harvest the quadratic twist of a curve, its order comes for free.
+ * @return how many primes the twist covers, 0 if it was not used
+ */
+static size_t invalid_harvest_twist(const curve_t *invalid, pari_ulong *primes,
+                                    size_t nprimes, unsigned long *done,
+                                    exhaustive_t *setup,
+                                    exhaustive_t *invalid_setup) {
+	pari_sp ltop = avma;
+	GEN order = twist_order(invalid);
+	bool divides = false;
+	for (size_t i = 0; i < nprimes && !divides; ++i) {
+		divides = !invalid_done(done, i) && dvdis(order, primes[i]);
+	}
+	avma = ltop;
+	if (!divides) {
+		return 0;
+	}
+
+	curve_t *twist = invalid_twist(invalid);
+	if (!twist) {
+		return 0;
+	}
+	verbose_log("trying the twist.\n");
+	size_t total = invalid_harvest(twist, primes, nprimes, done, setup,
+	                               invalid_setup);
+	curve_free(&twist);
+	avma = ltop;
+	return total;
+}
+
+/**
+ * @brief Generate the invalid curves for an original curve, one at a time.
+ *
+ * Every curve is output and freed as soon as it is generated, only the bitmap
+ * of the covered primes is kept, so the memory used does not grow with the
+ * number of primes.
+ */
+static size_t invalid_curves_single(invalid_original_t *original) {
+	const curve_t *curve = original->curve;
+	pari_ulong *primes = original->primes;
+	size_t nprimes = original->nprimes;
+	exhaustive_t *setup = &original->setup;
 	arg_t *invalid_argss[OFFSET_END] = {NULL};
 	exhaustive_t invalid_setup = {.generators = setup->generators,
 	                              .gen_argss = invalid_argss,
@@ -125,6 +254,9 @@ static size_t invalid_curves_single(const curve_t *curve, pari_ulong *primes,
 	                              .check_argss = setup->check_argss,
 	                              .unrolls = setup->unrolls};
 
+	unsigned long *done = try_calloc((nprimes + BITS_IN_LONG - 1) /
+	                                 BITS_IN_LONG * sizeof(unsigned long));
+
 	curve_t *invalid = curve_new();
 	/* copy field + a from curve to invalid */
 	invalid->field = gcopy(curve->field);
@@ -134,202 +266,419 @@ static size_t invalid_curves_single(const curve_t *curve, pari_ulong *primes,
 	while (ncurves < nprimes) {
 		pari_sp btop = avma;
 		/* generate a curve with random b */
-		exhaustive_gen(invalid, setup, OFFSET_B, OFFSET_GENERATORS);
+		if (!exhaustive_gen(invalid, setup, OFFSET_B, OFFSET_ORDER) &&
+		    timeout_expired()) {
+			order_unroll(invalid, avma, btop);
+			curve_unroll(invalid, avma, btop);
+			avma = btop;
+			break;
+		}
+		if (cfg->prefilter) {
+			/* skip the order if no uncovered prime divides it */
+			pari_ulong uncovered[nprimes];
+			size_t nuncovered = 0;
+			for (size_t i = 0; i < nprimes; ++i) {
+				if (!invalid_done(done, i)) uncovered[nuncovered++] = primes[i];
+			}
+			if (!invalid_screen(invalid, uncovered, nuncovered)) {
+				order_unroll(invalid, avma, btop);
+				curve_unroll(invalid, avma, btop);
+				avma = btop;
+				continue;
+			}
+		}
+		if (!exhaustive_gen(invalid, setup, OFFSET_ORDER, OFFSET_GENERATORS) &&
+		    timeout_expired()) {
+			gens_unroll(invalid, avma, btop);
+			order_unroll(invalid, avma, btop);
+			curve_unroll(invalid, avma, btop);
+			avma = btop;
+			break;
+		}
+
+		size_t covered = invalid_harvest(invalid, primes, nprimes, done,
+		                                 setup, &invalid_setup);
+		if (cfg->invalid_twists && ncurves + covered < nprimes) {
+			covered += invalid_harvest_twist(invalid, primes, nprimes, done,
+			                                 setup, &invalid_setup);
+		}
+		if (covered) {
+			ncurves += covered;
+			verbose_log("curves done: %lu out of %lu needed. %.0f%% \n",
+			            ncurves, nprimes, ((float)(ncurves) / nprimes) * 100);
+		}
 
 		/*
-		 * does some small prime from our array divide the curve order?
-		 * if so how many?
+		 * the curve is either output already, or no primes from range
+		 * divided its order. Thus unroll it like it never existed.
 		 */
-		size_t total = 0;
-		for (size_t i = nprimes; i-- > 0;) {
-			if (curves[i] == NULL && dvdis(invalid->order, primes[i])) {
-				if (!total) {
-					verbose_log(
-					    "we have a new one, calculating prime order points.\n");
-				}
-				total++;
-			}
-		}
+		points_unroll(invalid, avma, btop);
+		gens_unroll(invalid, avma, btop);
+		order_unroll(invalid, avma, btop);
+		curve_unroll(invalid, avma, btop);
+		avma = btop;
+	}
+	curve_free(&invalid);
+	try_free(done);
+
+	return ncurves;
+}
+
+/**
+ * @brief Generate the points of a picked candidate of the plan, and output it
+ * once for each prime it newly covers.
+ * @return how many primes the candidate covers, 0 if it failed
+ */
+static size_t invalid_plan_commit(plan_t *plan, size_t i,
+                                  const curve_t *invalid, exhaustive_t *setup,
+                                  exhaustive_t *invalid_setup) {
+	pari_sp btop = avma;
+	const plan_candidate_t *candidate = plan_get(plan, i);
+	curve_t *chosen = curve_new();
+	chosen->field = invalid->field;
+	chosen->a = gcopy(candidate->a);
+	chosen->b = gcopy(candidate->b);
+	// the order is known, so the curve is built directly
+	if (curve_gen_any(chosen, NULL, OFFSET_CURVE) <= 0) {
+		plan_drop(plan, i);
+		curve_free(&chosen);
+		avma = btop;
+		return 0;
+	}
+	chosen->order = gcopy(candidate->order);
+	obj_insert_shallow(chosen->curve, 1, chosen->order);
+
+	if (!exhaustive_gen_retry(chosen, setup, OFFSET_GENERATORS, OFFSET_POINTS,
+	                          1)) {
+		plan_drop(plan, i);
+		curve_free(&chosen);
+		avma = btop;
+		return 0;
+	}
+
+	pari_ulong primes[plan->nprimes];
+	size_t nprimes = plan_take(plan, i, primes);
+	arg_t prime_divisors = {primes, nprimes};
+	invalid_setup->gen_argss[OFFSET_POINTS] = &prime_divisors;
+	exhaustive_gen(chosen, invalid_setup, OFFSET_POINTS, OFFSET_END);
+	invalid_setup->gen_argss[OFFSET_POINTS] = NULL;
+
+	char *output = output_s(chosen);
+	for (size_t j = 0; j < nprimes; ++j) {
+		output_o_separator();
+		output_o_raw(output);
+	}
+	try_free(output);
+	verbose_log("curve output: %lu primes from range divide order.\n",
+	            nprimes);
+
+	curve_free(&chosen);
+	avma = btop;
+	return nprimes;
+}
+
+/**
+ * @brief Generate the invalid curves for an original curve by a plan.
+ *
+ * The orders of candidate curves are collected first, points are only
+ * generated on a small set of candidates that covers the primes, see plan_t.
+ * Without a given range, the primes only need a product over order^2, so the
+ * next primes are added to replace those that do not come up.
+ * @param original
+ * @param needed how many primes the plan needs covered
+ * @return how many primes got covered
+ */
+static size_t invalid_curves_planned(invalid_original_t *original,
+                                     size_t *needed) {
+	const curve_t *curve = original->curve;
+	exhaustive_t *setup = &original->setup;
+	arg_t *invalid_argss[OFFSET_END] = {NULL};
+	exhaustive_t invalid_setup = {.generators = setup->generators,
+	                              .gen_argss = invalid_argss,
+	                              .validators = setup->validators,
+	                              .check_argss = setup->check_argss,
+	                              .unrolls = setup->unrolls};
+
+	pari_sp ltop = avma;
+	size_t nprimes = original->nprimes;
+	double target = 0;
+	if (!cfg->invalid_primes) {
+		nprimes *= 2;
+		target = dbllog2(sqri(curve->order));
+	}
+	pari_ulong primes[nprimes];
+	memcpy(primes, original->primes, original->nprimes * sizeof(pari_ulong));
+	for (size_t i = original->nprimes; i < nprimes; ++i) {
+		primes[i] = unextprime(primes[i - 1] + 1);
+	}
+	avma = ltop;
+	plan_t *plan = plan_new(primes, nprimes, target, 4 * nprimes);
+	size_t picks[plan->size];
+
+	curve_t *invalid = curve_new();
+	/* copy field + a from curve to invalid */
+	invalid->field = gcopy(curve->field);
+	invalid->a = gcopy(curve->a);
 
-		if (total > 0) {
-			if (!exhaustive_gen_retry(invalid, setup, OFFSET_GENERATORS,
-			                          OFFSET_POINTS, 1)) {
-				curve_unroll(invalid, avma,
-				             btop);  // necessary to free the ellinit
+	size_t ncurves = 0;
+	bool replan = false;
+	while (!plan_complete(plan)) {
+		pari_sp btop = avma;
+		/*
+		 * the points are only generated once the plan is picked, so leave a
+		 * part of the run for them, the deadline would stop them otherwise
+		 */
+		bool expired = timeout_expiring(INVALID_PLAN_RESERVE);
+		/* generate a curve with random b and keep its order */
+		expired = expired ||
+		          (!exhaustive_gen(invalid, setup, OFFSET_B, OFFSET_ORDER) &&
+		           timeout_expired());
+		if (!expired && cfg->prefilter) {
+			pari_ulong uncovered[nprimes];
+			size_t nuncovered = plan_uncovered(plan, uncovered);
+			if (!invalid_screen(invalid, uncovered, nuncovered)) {
+				order_unroll(invalid, avma, btop);
+				curve_unroll(invalid, avma, btop);
 				avma = btop;
 				continue;
 			}
-
-			/*
-			 * only pass small primes that divide the curve order and those
-			 * where we dont have a curve yet.
-			 * this is passed to points_gen_trial which uses trial division to
-			 * find
-			 * a point with given prime order.
-			 */
-			size_t j = 0;
-			pari_ulong dprimes[total];
-			for (size_t i = 0; i < nprimes; ++i) {
-				if (curves[i] == NULL && dvdis(invalid->order, primes[i])) {
-					verbose_log("prime %lu divides curve order.\n", primes[i]);
-					dprimes[j++] = primes[i];
-				}
-			}
-			arg_t prime_divisors = {dprimes, total};
-			invalid_argss[OFFSET_POINTS] = &prime_divisors;
-
-			/*
-			 * generate prime order points, this is expensive (order needs to be
-			 * factorised, so only do it if we want the curve)
-			 */
-			exhaustive_gen(invalid, &invalid_setup, OFFSET_POINTS, OFFSET_END);
-
-			size_t count = 0;
-			for (size_t i = nprimes; i-- > 0;) {
-				if (curves[i] == NULL && dvdis(invalid->order, primes[i])) {
-					if (count == 0) {
-						// save a copy on first prime divisor from range
-						curves[i] = invalid;
-					} else {
-						// copy if pointer already assigned
-						curves[i] = curve_new_copy(invalid);
-					}
-					output_o(curves[i]);
-					if (ncurves != nprimes - 1) {
-						output_o_separator();
-					}
-					ncurves++;
-					count++;
+		}
+		expired = expired || (!exhaustive_gen(invalid, setup, OFFSET_ORDER,
+		                                      OFFSET_GENERATORS) &&
+		                      timeout_expired());
+		if (!expired) {
+			replan |= plan_add(plan, invalid->a, invalid->b, invalid->order);
+			if (cfg->invalid_twists) {
+				curve_t *twist = invalid_twist(invalid);
+				if (twist) {
+					replan |=
+					    plan_add(plan, twist->a, twist->b, twist->order);
+					curve_free(&twist);
 				}
 			}
+		}
+		order_unroll(invalid, avma, btop);
+		curve_unroll(invalid, avma, btop);
+		avma = btop;
 
-			/*
-			 * copy the curve params that stay into a new curve, since this
-			 * curve pointer got assigned
-			 * this is for performance reasons. As it only copies the curve
-			 * and allocs memory if this curve is saved.
-			 */
-			invalid = curve_new();
-			invalid->field = gcopy(curve->field);
-			invalid->a = gcopy(curve->a);
-
-			verbose_log("curve saved: %lu primes from range divide order.\n",
-			            total);
-			verbose_log("curves done: %lu out of %lu needed. %.0f%% \n",
-			            ncurves, nprimes, ((float)(ncurves) / nprimes) * 100);
-		} else {
-			/*
-			 * here, we generated the curve but didn't use it, because no
-			 * primes from range divided order. Thus unroll it
-			 * like it never existed, but don't free it yet.
-			 */
-
-			curve_unroll(invalid, avma, btop);
-			avma = btop;
+		/*
+		 * the pick only changes when the pool does, once the candidates
+		 * complete the plan, or time is up, use them
+		 */
+		if (!replan && !expired) {
+			continue;
+		}
+		replan = false;
+		size_t npicks = plan_pick(plan, picks, expired);
+		for (size_t i = 0; i < npicks; ++i) {
+			size_t covered = invalid_plan_commit(plan, picks[i], invalid,
+			                                     setup, &invalid_setup);
+			// a candidate that failed leaves the others to be picked again
+			replan |= !covered;
+			ncurves += covered;
+		}
+		if (npicks) {
+			verbose_log("curves done: %lu, with %lu points generated.\n",
+			            ncurves, npicks);
+		}
+		if (expired) {
+			break;
 		}
 	}
+	*needed = plan_complete(plan) ? ncurves : original->nprimes;
 	curve_free(&invalid);
+	plan_free(&plan);
 
 	return ncurves;
 }
 
-static size_t invalid_curves_threaded(const curve_t *curve, pari_ulong *primes,
-                                      size_t nprimes, curve_t **curves,
-                                      exhaustive_t *setup) {
+/**
+ * @brief Output the results of a group and free them.
+ * @return how many primes the results cover
+ */
+static size_t invalid_group_output(invalid_result_t *results) {
+	size_t ncurves = 0;
+	while (results) {
+		invalid_result_t *next = results->next;
+		for (size_t i = 0; i < results->nprimes; ++i) {
+			output_o_separator();
+			output_o_raw(results->output);
+		}
+		ncurves += results->nprimes;
+		try_free(results->output);
+		try_free(results);
+		results = next;
+	}
+	return ncurves;
+}
+
+/**
+ * @brief Output the original curve of a group, followed by the results that
+ * waited for it.
+ * @return how many primes the results cover
+ */
+static size_t invalid_group_begin(const invalid_original_t *original,
+                                  invalid_result_t *pending) {
+	output_o_begin();
+	output_o(original->curve);
+	return invalid_group_output(pending);
+}
+
+static size_t invalid_curves_threaded(invalid_original_t *originals,
+                                      size_t noriginals) {
 	pthread_t pthreads[cfg->threads];
 	thread_t threads[cfg->threads];
 	struct pari_thread pari_threads[cfg->threads];
 
-	size_t *generated = try_calloc(sizeof(size_t));
-	state_e *states = try_calloc(sizeof(state_e) * nprimes);
-	state_e *old_states = try_calloc(sizeof(state_e) * nprimes);
-	curve_t **local_curves = try_calloc(sizeof(curve_t *) * nprimes);
-	for (size_t i = 0; i < nprimes; ++i) {
-		states[i] = STATE_FREE;
-		old_states[i] = STATE_FREE;
-	}
-	pthread_mutex_t state_mutex = PTHREAD_MUTEX_INITIALIZER;
-	pthread_cond_t generated_cond = PTHREAD_COND_INITIALIZER;
+	atomic_size_t done = ATOMIC_VAR_INIT(0);
+	atomic_size_t running = ATOMIC_VAR_INIT(cfg->threads);
+	queue_t *results = queue_new(cfg->threads * 2);
 
 	for (size_t i = 0; i < cfg->threads; ++i) {
 		pari_thread_alloc(&pari_threads[i], cfg->thread_memory,
 		                  (GEN)&threads[i]);
 
 		threads[i].pari_thread = &pari_threads[i];
-		threads[i].original_curve = curve;
-		threads[i].nprimes = nprimes;
-		threads[i].primes = primes;
-		threads[i].states = states;
-		threads[i].curves = local_curves;
-		threads[i].generated = generated;
-		threads[i].mutex_state = &state_mutex;
-		threads[i].cond_generated = &generated_cond;
+		threads[i].index = i;
+		threads[i].originals = originals;
+		threads[i].noriginals = noriginals;
+		threads[i].done = &done;
+		threads[i].running = &running;
+		threads[i].results = results;
 		threads[i].cfg = cfg;
-		threads[i].setup = setup;
 	}
 
-	pthread_mutex_lock(&state_mutex);
 	for (size_t i = 0; i < cfg->threads; ++i) {
 		pthread_create(&pthreads[i], NULL, &invalid_thread,
 		               (void *)&threads[i]);
 	}
 
-	while (true) {
-		pthread_cond_wait(&generated_cond, &state_mutex);
-		for (size_t i = 0; i < nprimes; ++i) {
-			if (old_states[i] != states[i] && states[i] == STATE_GENERATED) {
-				output_o(local_curves[i]);
-				if (*generated != nprimes) {
-					output_o_separator();
-				}
-				old_states[i] = states[i];
+	/*
+	 * This thread is the writer, it outputs the curves as they come, until
+	 * the last worker exits and closes the queue. The groups go out in the
+	 * order of the originals, results for a later one wait in its list.
+	 */
+	size_t received[noriginals];
+	invalid_result_t *pending[noriginals];
+	invalid_result_t **tails[noriginals];
+	for (size_t k = 0; k < noriginals; ++k) {
+		received[k] = 0;
+		pending[k] = NULL;
+		tails[k] = &pending[k];
+	}
+
+	size_t ncurves = 0;
+	size_t current = 0;
+	invalid_group_begin(&originals[current], NULL);
+	invalid_result_t *result;
+	while ((result = queue_pop(results))) {
+		size_t k = result->original;
+		received[k] += result->nprimes;
+		result->next = NULL;
+		if (k == current) {
+			ncurves += invalid_group_output(result);
+		} else {
+			*tails[k] = result;
+			tails[k] = &result->next;
+		}
+		verbose_log("curves done: %lu out of %lu needed. %.0f%% \n",
+		            received[k], originals[k].nprimes,
+		            ((float)(received[k]) / originals[k].nprimes) * 100);
+
+		while (current < noriginals &&
+		       received[current] == originals[current].nprimes) {
+			// the group is complete, move on to the next one
+			output_o_end();
+			if (++current < noriginals) {
+				ncurves +=
+				    invalid_group_begin(&originals[current], pending[current]);
 			}
 		}
-
-		if (*generated == nprimes)
-			break;
 	}
-	pthread_mutex_unlock(&state_mutex);
+	// cut short by the deadline, output what there is
+	while (current < noriginals) {
+		output_o_end();
+		if (++current < noriginals) {
+			ncurves +=
+			    invalid_group_begin(&originals[current], pending[current]);
+		}
+	}
 
 	for (size_t i = 0; i < cfg->threads; ++i) {
 		pthread_join(pthreads[i], NULL);
 	}
-
-	for (size_t i = 0; i < nprimes; ++i) {
-		curves[i] = curve_new_copy(local_curves[i]);
-		curve_free(&local_curves[i]);
-	}
-
 	for (size_t i = 0; i < cfg->threads; ++i) {
 		pari_thread_free(&pari_threads[i]);
 	}
-	pthread_mutex_destroy(&state_mutex);
-	pthread_cond_destroy(&generated_cond);
-
-	size_t result = *generated;
-	try_free(generated);
-	try_free(states);
-	try_free(old_states);
-	try_free(local_curves);
+	queue_free(&results);
 
-	return result;
+	return ncurves;
 }
 
 curve_t *invalid_original_curve(exhaustive_t *setup) {
 	curve_t *curve = curve_new();
 	if (!exhaustive_gen(curve, setup, OFFSET_FIELD, OFFSET_POINTS)) {
-		exhaustive_clear(setup);
 		curve_free(&curve);
-		exit(EXIT_FAILURE);
+		return NULL;
 	}
 	return curve;
 }
 
+/**
+ * @brief Set up the invalid curve generation for an original curve, its
+ * primes and the template of its field and a.
+ * @return whether there are any primes to generate curves for
+ */
+static bool invalid_original_init(invalid_original_t *original,
+                                  curve_t *curve, exhaustive_t *common) {
+	original->curve = curve;
+	invalid_invalid_ginit(original->generators);
+	original->setup =
+	    (exhaustive_t){.generators = original->generators,
+	                   .gen_argss = original->gen_argss,
+	                   .validators = common->validators,
+	                   .check_argss = common->check_argss,
+	                   .unrolls = common->unrolls};
+
+	// the field and a stay, so only the b dependent part of curves is built
+	GEN template = curve_template_new(curve);
+	if (template) {
+		original->generators[OFFSET_CURVE] = &curve_gen_template;
+		original->gen_argss[OFFSET_CURVE] = arg_new();
+		original->gen_argss[OFFSET_CURVE]->args = template;
+	}
+
+	debug_log_start("Starting to generate primes to product over order^2");
+	original->nprimes = invalid_primes(curve->order, &original->primes);
+	debug_log_end("Generated primes");
+
+	if (!original->nprimes) {
+		return false;
+	}
+
+	original->states = try_calloc(sizeof(_Atomic(state_e)) * original->nprimes);
+	for (size_t i = 0; i < original->nprimes; ++i) {
+		atomic_init(&original->states[i], STATE_FREE);
+	}
+	atomic_init(&original->generated, 0);
+	return true;
+}
+
+static void invalid_original_quit(invalid_original_t *original) {
+	if (original->gen_argss[OFFSET_CURVE]) {
+		GEN template = (GEN)original->gen_argss[OFFSET_CURVE]->args;
+		curve_template_free(&template);
+		arg_free(&original->gen_argss[OFFSET_CURVE]);
+	}
+	try_free(original->states);
+	try_free(original->primes);
+	curve_free(&original->curve);
+}
+
 int invalid_do() {
 	debug_log_start("Starting Invalid curve method");
 
 	gen_f original_gens[OFFSET_END] = {NULL};
-	gen_f invalid_gens[OFFSET_END] = {NULL};
 	check_t *common_validators[OFFSET_END] = {NULL};
 	arg_t *common_gen_argss[OFFSET_END] = {NULL};
 	arg_t *common_check_argss[OFFSET_END] = {NULL};
@@ -343,53 +692,96 @@ int invalid_do() {
 	invalid_init(&original_setup);
 	invalid_original_ginit(original_gens);
 
-	exhaustive_t invalid_setup = {.generators = invalid_gens,
-	                              .gen_argss = common_gen_argss,
-	                              .validators = common_validators,
-	                              .check_argss = common_check_argss,
-	                              .unrolls = common_unrolls};
-	invalid_invalid_ginit(invalid_gens);
-
-	debug_log_start("Starting to create curve to invalidate");
-	curve_t *curve = invalid_original_curve(&original_setup);
-	debug_log_end("Finished creating curve to invalidate");
-
-	output_o_begin();
-	output_o(curve);
-	output_o_separator();
-
-	debug_log_start("Starting to generate primes to product over order^2");
-	pari_ulong *primes;
-	size_t nprimes = invalid_primes(curve->order, &primes);
-	debug_log_end("Generated primes");
+	/*
+	 * In batch mode, every input record is an original curve, they all share
+	 * one run (and one thread pool), but are output in separate groups.
+	 */
+	int status = EXIT_SUCCESS;
+	size_t size = 1;
+	size_t noriginals = 0;
+	invalid_original_t *originals =
+	    try_calloc(size * sizeof(invalid_original_t));
+	while (!cfg->batch || input_next()) {
+		debug_log_start("Starting to create curve to invalidate");
+		curve_t *curve = invalid_original_curve(&original_setup);
+		debug_log_end("Finished creating curve to invalidate");
+		if (!curve) {
+			status = EXIT_FAILURE;
+			if (cfg->batch) continue;
+			break;
+		}
 
-	if (!nprimes) {
-		fprintf(err, "No orders to generate curves for, quitting.");
-		return EXIT_FAILURE;
+		if (noriginals == size) {
+			originals = try_realloc(originals,
+			                        size * 2 * sizeof(invalid_original_t));
+			memset(originals + size, 0, size * sizeof(invalid_original_t));
+			size *= 2;
+		}
+		invalid_original_t *original = &originals[noriginals++];
+		if (!invalid_original_init(original, curve, &original_setup)) {
+			if (cfg->batch) {
+				fprintf(err, "No orders to generate curves for.\n");
+			} else {
+				fprintf(err, "No orders to generate curves for, quitting.");
+			}
+			status = EXIT_FAILURE;
+			invalid_original_quit(original);
+			memset(original, 0, sizeof(invalid_original_t));
+			noriginals--;
+		}
+		if (!cfg->batch) break;
+	}
+	// the setups point into the array, which moved while it grew
+	for (size_t k = 0; k < noriginals; ++k) {
+		originals[k].setup.generators = originals[k].generators;
+		originals[k].setup.gen_argss = originals[k].gen_argss;
 	}
 
-	curve_t **curves = try_calloc(nprimes * sizeof(curve_t *));
 	debug_log_start("Starting to generate invalid curves");
-	size_t ncurves;
-	if (cfg->threads == 1) {
-		ncurves = invalid_curves_single(curve, primes, nprimes, curves,
-		                                &invalid_setup);
+	size_t ncurves = 0, needed = 0;
+	if (noriginals == 0) {
+		// nothing to do
+	} else if (cfg->threads == 1) {
+		for (size_t k = 0; k < noriginals; ++k) {
+			invalid_original_t *original = &originals[k];
+			output_o_begin();
+			output_o(original->curve);
+			if (cfg->invalid_plan) {
+				size_t planned;
+				ncurves += invalid_curves_planned(original, &planned);
+				needed += planned;
+			} else {
+				ncurves += invalid_curves_single(original);
+				needed += original->nprimes;
+			}
+			output_o_end();
+		}
 	} else {
-		ncurves = invalid_curves_threaded(curve, primes, nprimes, curves,
-		                                  &invalid_setup);
+		// the curves are already output and freed by then
+		ncurves = invalid_curves_threaded(originals, noriginals);
+		for (size_t k = 0; k < noriginals; ++k) {
+			needed += originals[k].nprimes;
+		}
 	}
 	debug_log_end("Finished generating invalid curves");
-	output_o_end();
+	if (ncurves < needed) {
+		verbose_log("Deadline reached, %lu out of %lu curves generated.\n",
+		            ncurves, needed);
+	}
+	if (cfg->prefilter) {
+		unsigned long tested, rejected;
+		invalid_screen_stats(&tested, &rejected);
+		verbose_log("Pre-filter rejected %lu of %lu curves (%.1f%%).\n",
+		            rejected, tested,
+		            tested ? 100.0 * rejected / tested : 0.0);
+	}
 
-	for (size_t i = 0; i < ncurves; ++i) {
-		curve_free(&curves[i]);
+	for (size_t k = 0; k < noriginals; ++k) {
+		invalid_original_quit(&originals[k]);
 	}
-	try_free(curves);
-	try_free(primes);
-	curve_free(&curve);
+	try_free(originals);
 	exhaustive_clear(&original_setup);
-	exhaustive_clear(&invalid_setup);
 
 	debug_log_end("Finished Invalid curve method");
-	return EXIT_SUCCESS;
+	return status;
 }
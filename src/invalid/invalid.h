@@ -11,7 +11,8 @@
 #include "misc/config.h"
 
 /**
- *
+ * @brief Generate invalid curves for an original curve, or in batch mode for
+ * every original curve in the input file, in one run.
  * @return
  */
 int invalid_do();
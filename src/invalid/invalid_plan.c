@@ -0,0 +1,206 @@
+/*
+ * ecgen, tool for generating Elliptic curve domain parameters
+ * Copyright (C) 2017-2018 J08nY
+ */
+#include "invalid_plan.h"
+#include <string.h>
+#include "util/memory.h"
+
+static size_t plan_words(const plan_t *plan) {
+	return (plan->nprimes + BITS_IN_LONG - 1) / BITS_IN_LONG;
+}
+
+static bool plan_bit(const unsigned long *bits, size_t i) {
+	return (bits[i / BITS_IN_LONG] >> (i % BITS_IN_LONG)) & 1;
+}
+
+static void plan_set_bit(unsigned long *bits, size_t i) {
+	bits[i / BITS_IN_LONG] |= 1UL << (i % BITS_IN_LONG);
+}
+
+/**
+ * @brief The sum of log2 of the primes the candidate covers, that are not
+ * covered yet.
+ */
+static double plan_weight(const plan_t *plan, const unsigned long *divides,
+                          const unsigned long *covered) {
+	double weight = 0;
+	for (size_t i = 0; i < plan->nprimes; ++i) {
+		if (plan_bit(divides, i) && !plan_bit(covered, i)) {
+			weight += plan->weights[i];
+		}
+	}
+	return weight;
+}
+
+static bool plan_reached(const plan_t *plan, size_t ncovered, double weight) {
+	if (plan->target > 0) {
+		return weight >= plan->target;
+	}
+	return ncovered == plan->nprimes;
+}
+
+plan_t *plan_new(const pari_ulong *primes, size_t nprimes, double target,
+                 size_t size) {
+	plan_t *plan = try_calloc(sizeof(plan_t));
+	plan->primes = try_calloc(nprimes * sizeof(pari_ulong));
+	memcpy(plan->primes, primes, nprimes * sizeof(pari_ulong));
+	plan->nprimes = nprimes;
+	plan->weights = try_calloc(nprimes * sizeof(double));
+	pari_sp ltop = avma;
+	for (size_t i = 0; i < nprimes; ++i) {
+		plan->weights[i] = dbllog2(utoipos(primes[i]));
+	}
+	avma = ltop;
+	plan->target = target;
+	plan->covered = try_calloc(plan_words(plan) * sizeof(unsigned long));
+	plan->candidates = try_calloc(size * sizeof(plan_candidate_t));
+	plan->size = size;
+	return plan;
+}
+
+bool plan_add(plan_t *plan, GEN a, GEN b, GEN order) {
+	pari_sp ltop = avma;
+	unsigned long *divides =
+	    try_calloc(plan_words(plan) * sizeof(unsigned long));
+	for (size_t i = 0; i < plan->nprimes; ++i) {
+		if (!plan_bit(plan->covered, i) && dvdis(order, plan->primes[i])) {
+			plan_set_bit(divides, i);
+		}
+	}
+	avma = ltop;
+	double weight = plan_weight(plan, divides, plan->covered);
+	if (weight == 0) {
+		try_free(divides);
+		return false;
+	}
+
+	// an empty slot, or the one covering the least
+	size_t slot = plan->size;
+	double least = weight;
+	for (size_t i = 0; i < plan->size; ++i) {
+		plan_candidate_t *candidate = &plan->candidates[i];
+		if (!candidate->order) {
+			slot = i;
+			break;
+		}
+		double w = plan_weight(plan, candidate->divides, plan->covered);
+		if (w < least) {
+			least = w;
+			slot = i;
+		}
+	}
+	if (slot == plan->size) {
+		try_free(divides);
+		return false;
+	}
+	plan_drop(plan, slot);
+
+	plan_candidate_t *candidate = &plan->candidates[slot];
+	candidate->a = gclone(a);
+	candidate->b = gclone(b);
+	candidate->order = gclone(order);
+	candidate->divides = divides;
+	return true;
+}
+
+size_t plan_pick(const plan_t *plan, size_t *picks, bool force) {
+	unsigned long covered[plan_words(plan)];
+	memcpy(covered, plan->covered, sizeof(covered));
+	size_t ncovered = plan->ncovered;
+	double weight = plan->weight;
+	bool picked[plan->size];
+	memset(picked, 0, sizeof(picked));
+
+	size_t npicks = 0;
+	while (!plan_reached(plan, ncovered, weight)) {
+		size_t best = plan->size;
+		double most = 0;
+		for (size_t i = 0; i < plan->size; ++i) {
+			const plan_candidate_t *candidate = &plan->candidates[i];
+			if (!candidate->order || picked[i]) continue;
+			double w = plan_weight(plan, candidate->divides, covered);
+			if (w > most) {
+				most = w;
+				best = i;
+			}
+		}
+		if (best == plan->size) {
+			break;
+		}
+
+		picked[best] = true;
+		picks[npicks++] = best;
+		for (size_t i = 0; i < plan->nprimes; ++i) {
+			if (plan_bit(plan->candidates[best].divides, i) &&
+			    !plan_bit(covered, i)) {
+				plan_set_bit(covered, i);
+				ncovered++;
+			}
+		}
+		weight += most;
+	}
+
+	if (!force && !plan_reached(plan, ncovered, weight)) {
+		return 0;
+	}
+	return npicks;
+}
+
+const plan_candidate_t *plan_get(const plan_t *plan, size_t i) {
+	return &plan->candidates[i];
+}
+
+size_t plan_take(plan_t *plan, size_t i, pari_ulong *primes) {
+	plan_candidate_t *candidate = &plan->candidates[i];
+	size_t nprimes = 0;
+	for (size_t j = 0; j < plan->nprimes; ++j) {
+		if (plan_bit(candidate->divides, j) && !plan_bit(plan->covered, j)) {
+			plan_set_bit(plan->covered, j);
+			plan->ncovered++;
+			plan->weight += plan->weights[j];
+			primes[nprimes++] = plan->primes[j];
+		}
+	}
+	plan_drop(plan, i);
+	return nprimes;
+}
+
+void plan_drop(plan_t *plan, size_t i) {
+	plan_candidate_t *candidate = &plan->candidates[i];
+	if (candidate->order) {
+		gunclone(candidate->a);
+		gunclone(candidate->b);
+		gunclone(candidate->order);
+		try_free(candidate->divides);
+		memset(candidate, 0, sizeof(plan_candidate_t));
+	}
+}
+
+size_t plan_uncovered(const plan_t *plan, pari_ulong *primes) {
+	size_t nprimes = 0;
+	for (size_t i = 0; i < plan->nprimes; ++i) {
+		if (!plan_bit(plan->covered, i)) {
+			primes[nprimes++] = plan->primes[i];
+		}
+	}
+	return nprimes;
+}
+
+bool plan_complete(const plan_t *plan) {
+	return plan_reached(plan, plan->ncovered, plan->weight);
+}
+
+void plan_free(plan_t **plan) {
+	if (*plan) {
+		for (size_t i = 0; i < (*plan)->size; ++i) {
+			plan_drop(*plan, i);
+		}
+		try_free((*plan)->candidates);
+		try_free((*plan)->covered);
+		try_free((*plan)->weights);
+		try_free((*plan)->primes);
+		try_free(*plan);
+		*plan = NULL;
+	}
+}
@@ -0,0 +1,142 @@
+/*
+ * ecgen, tool for generating Elliptic curve domain parameters
+ * Copyright (C) 2017-2018 J08nY
+ */
+/**
+ * @file invalid_plan.h
+ */
+#ifndef ECGEN_INVALID_INVALID_PLAN_H
+#define ECGEN_INVALID_INVALID_PLAN_H
+
+#include <stdbool.h>
+#include "misc/types.h"
+
+/**
+ * @brief A candidate invalid curve, its order is known but its points are not
+ * generated yet.
+ * @param a
+ * @param b
+ * @param order
+ * @param divides bitmap of the primes of the plan that divide the order
+ */
+typedef struct {
+	GEN a;
+	GEN b;
+	GEN order;
+	unsigned long *divides;
+} plan_candidate_t;
+
+/**
+ * @brief A pool of candidate invalid curves, from which a small set covering
+ * the primes is picked, so that few curves need their points generated.
+ * @param primes the primes to cover
+ * @param nprimes
+ * @param weights log2 of the primes
+ * @param target the sum of log2 of the covered primes to reach, or 0 if all
+ * of them need to be covered
+ * @param covered bitmap of the covered primes
+ * @param ncovered
+ * @param weight the sum of log2 of the covered primes
+ * @param candidates the pool, a slot without an order is empty
+ * @param size the size of the pool
+ */
+typedef struct {
+	pari_ulong *primes;
+	size_t nprimes;
+	double *weights;
+	double target;
+	unsigned long *covered;
+	size_t ncovered;
+	double weight;
+	plan_candidate_t *candidates;
+	size_t size;
+} plan_t;
+
+/**
+ * @brief Create a new plan.
+ * @param primes the primes to cover, copied
+ * @param nprimes
+ * @param target the sum of log2 of the covered primes to reach, or 0 if all
+ * of them need to be covered
+ * @param size how many candidates to keep at most
+ * @return
+ */
+plan_t *plan_new(const pari_ulong *primes, size_t nprimes, double target,
+                 size_t size);
+
+/**
+ * @brief Add a candidate curve to the plan.
+ *
+ * The candidate is kept if some uncovered prime divides its order. If the
+ * pool is full, the candidate that covers the least replaces the one that
+ * covers the least in the pool, if any.
+ * @param plan
+ * @param a
+ * @param b
+ * @param order
+ * @return whether the candidate was kept
+ */
+bool plan_add(plan_t *plan, GEN a, GEN b, GEN order);
+
+/**
+ * @brief Pick the candidates to generate the points on.
+ *
+ * Greedily picks the candidate covering the most (by log2 of the uncovered
+ * primes dividing its order) until the plan is complete, so candidates
+ * covering several primes at once go first.
+ * @param plan
+ * @param picks where to store the indexes of the picked candidates, of the
+ * size of the pool
+ * @param force whether to pick even if the candidates do not complete the plan
+ * @return the number of picked candidates, 0 if they do not complete the plan
+ * and force is false
+ */
+size_t plan_pick(const plan_t *plan, size_t *picks, bool force);
+
+/**
+ * @brief Get a candidate of the plan.
+ * @param plan
+ * @param i
+ * @return
+ */
+const plan_candidate_t *plan_get(const plan_t *plan, size_t i);
+
+/**
+ * @brief Cover the primes a candidate covers and remove it from the pool.
+ * @param plan
+ * @param i
+ * @param primes where to store the primes newly covered, of the size of the
+ * plan
+ * @return how many primes are newly covered
+ */
+size_t plan_take(plan_t *plan, size_t i, pari_ulong *primes);
+
+/**
+ * @brief Remove a candidate from the pool, without covering anything.
+ * @param plan
+ * @param i
+ */
+void plan_drop(plan_t *plan, size_t i);
+
+/**
+ * @brief Get the primes that are not covered yet.
+ * @param plan
+ * @param primes where to store them, of the size of the plan
+ * @return how many primes are not covered
+ */
+size_t plan_uncovered(const plan_t *plan, pari_ulong *primes);
+
+/**
+ * @brief Whether the covered primes complete the plan.
+ * @param plan
+ * @return
+ */
+bool plan_complete(const plan_t *plan);
+
+/**
+ * @brief Free a plan, with its candidates.
+ * @param plan
+ */
+void plan_free(plan_t **plan);
+
+#endif  // ECGEN_INVALID_INVALID_PLAN_H
@@ -6,88 +6,245 @@
 #include "invalid_thread.h"
 #include "gen/curve.h"
 #include "gen/gens.h"
+#include "gen/order.h"
 #include "gen/point.h"
+#include "math/torsion.h"
+#include "math/twists.h"
 #include "obj/curve.h"
+#include "util/memory.h"
 #include "util/random.h"
 #include "util/timeout.h"
 
-static size_t invalid_get_generated(thread_t *thread) {
-	pthread_mutex_lock(thread->mutex_state);
-	size_t result = *thread->generated;
-	pthread_mutex_unlock(thread->mutex_state);
-	return result;
+static bool invalid_claim(invalid_original_t *original, size_t i) {
+	state_e expected = STATE_FREE;
+	return atomic_compare_exchange_strong(&original->states[i], &expected,
+	                                      STATE_GENERATING);
+}
+
+static atomic_ulong screen_tested = ATOMIC_VAR_INIT(0);
+static atomic_ulong screen_rejected = ATOMIC_VAR_INIT(0);
+
+bool invalid_screen(const curve_t *curve, const pari_ulong *primes,
+                    size_t nprimes) {
+	if (cfg->field != FIELD_PRIME) return true;
+	atomic_fetch_add(&screen_tested, 1);
+	bool twist = cfg->invalid_twists == TWISTS_ANY ||
+	             (cfg->invalid_twists == TWISTS_SAME_A && twist_keeps_a(curve));
+	if (torsion_divides_any(curve, primes, nprimes, cfg->prefilter_bound,
+	                        twist)) {
+		return true;
+	}
+	atomic_fetch_add(&screen_rejected, 1);
+	return false;
+}
+
+void invalid_screen_stats(unsigned long *tested, unsigned long *rejected) {
+	*tested = atomic_load(&screen_tested);
+	*rejected = atomic_load(&screen_rejected);
+}
+
+curve_t *invalid_twist(const curve_t *curve) {
+	curve_t *twist = curve_new();
+	if (twist_same_a_to(twist, curve)) {
+		return twist;
+	}
+	if (cfg->invalid_twists == TWISTS_ANY) {
+		twist_rand_to(twist, curve);
+		return twist;
+	}
+	curve_free(&twist);
+	return NULL;
+}
+
+/**
+ * @brief Claim the free primes dividing the order of a curve, generate its
+ * points and hand it to the output.
+ * @return how many primes the curve covers, 0 if it was not used
+ */
+static size_t invalid_thread_harvest(thread_t *thread, size_t k,
+                                     curve_t *invalid,
+                                     exhaustive_t *invalid_setup) {
+	invalid_original_t *original = &thread->originals[k];
+	size_t ndivides = 0;
+	for (size_t i = original->nprimes; i-- > 0;) {
+		if (atomic_load(&original->states[i]) == STATE_FREE &&
+		    dvdis(invalid->order, original->primes[i])) {
+			// whoo we have a new invalid curve
+			ndivides++;
+		}
+	}
+
+	if (ndivides == 0 ||
+	    !exhaustive_gen_retry(invalid, invalid_setup, OFFSET_GENERATORS,
+	                          OFFSET_POINTS, 1)) {
+		return 0;
+	}
+
+	pari_ulong primes[original->nprimes];
+	size_t nprimes = 0;
+	for (size_t i = original->nprimes; i-- > 0;) {
+		if (dvdis(invalid->order, original->primes[i]) &&
+		    invalid_claim(original, i)) {
+			primes[nprimes++] = original->primes[i];
+		}
+	}
+	if (nprimes == 0) {
+		return 0;
+	}
+
+	arg_t prime_divisors = {primes, nprimes};
+	invalid_setup->gen_argss[OFFSET_POINTS] = &prime_divisors;
+	exhaustive_gen(invalid, invalid_setup, OFFSET_POINTS, OFFSET_END);
+	invalid_setup->gen_argss[OFFSET_POINTS] = NULL;
+
+	// the claimed slots are ours, publish them without the lock
+	size_t count = 0;
+	for (size_t i = original->nprimes; i-- > 0;) {
+		if (count < nprimes && primes[count] == original->primes[i]) {
+			atomic_store(&original->states[i], STATE_GENERATED);
+			count++;
+		}
+	}
+	if (atomic_fetch_add(&original->generated, count) + count ==
+	    original->nprimes) {
+		atomic_fetch_add(thread->done, 1);
+	}
+
+	// hand the curve to the output, it is not needed here anymore
+	invalid_result_t *result = try_calloc(sizeof(invalid_result_t));
+	result->original = k;
+	result->output = output_s(invalid);
+	result->nprimes = count;
+	queue_push(thread->results, result);
+	return count;
+}
+
+/**
+ * @brief Harvest the quadratic twist of a curve, its order comes for free.
+ */
+static void invalid_thread_twist(thread_t *thread, size_t k,
+                                 const curve_t *invalid,
+                                 exhaustive_t *invalid_setup) {
+	invalid_original_t *original = &thread->originals[k];
+	GEN order = twist_order(invalid);
+	bool divides = false;
+	for (size_t i = 0; i < original->nprimes && !divides; ++i) {
+		divides = atomic_load(&original->states[i]) == STATE_FREE &&
+		          dvdis(order, original->primes[i]);
+	}
+	if (!divides) {
+		return;
+	}
+
+	curve_t *twist = invalid_twist(invalid);
+	if (twist) {
+		invalid_thread_harvest(thread, k, twist, invalid_setup);
+		curve_free(&twist);
+	}
+}
+
+/**
+ * @brief Pick the next original that still has uncovered primes, going round
+ * from the one after <code>last</code>.
+ * @return the index of the original, or noriginals if all are covered
+ */
+static size_t invalid_thread_next(thread_t *thread, size_t last) {
+	for (size_t j = 1; j <= thread->noriginals; ++j) {
+		size_t k = (last + j) % thread->noriginals;
+		invalid_original_t *original = &thread->originals[k];
+		if (atomic_load(&original->generated) < original->nprimes) {
+			return k;
+		}
+	}
+	return thread->noriginals;
 }
 
 void *invalid_thread(void *arg) {
 	thread_t *thread = (thread_t *)arg;
 	pari_thread_start(thread->pari_thread);
-	random_init();
+	if (!random_stream(thread->index + 1)) {
+		random_init();
+	}
 	timeout_thread_init();
 	arg_t *invalid_argss[OFFSET_END] = {NULL};
-	exhaustive_t invalid_setup = {.generators = thread->setup->generators,
-	                              .validators = thread->setup->validators,
-	                              .gen_argss = invalid_argss,
-	                              .unrolls = thread->setup->unrolls};
 
-	curve_t *invalid = curve_new();
-	invalid->field = gcopy(thread->original_curve->field);
-	invalid->a = gcopy(thread->original_curve->a);
+	// one invalid curve per original, with its field and a, made when needed
+	curve_t **invalids = try_calloc(thread->noriginals * sizeof(curve_t *));
 
-	while (invalid_get_generated(thread) < thread->nprimes) {
-		pari_sp btop = avma;
-		exhaustive_gen(invalid, thread->setup, OFFSET_B, OFFSET_GENERATORS);
-		size_t ndivides = 0;
-		size_t nfree = 0;
-		for (size_t i = thread->nprimes; i-- > 0;) {
-			if (dvdis(invalid->order, thread->primes[i])) {
-				// whoo we have a new invalid curve
-				ndivides++;
-			}
+	// spread the workers over the originals
+	size_t k = (thread->index + thread->noriginals - 1) % thread->noriginals;
+	while (atomic_load(thread->done) < thread->noriginals &&
+	       !timeout_expired()) {
+		k = invalid_thread_next(thread, k);
+		if (k == thread->noriginals) {
+			break;
 		}
+		invalid_original_t *original = &thread->originals[k];
+		if (!invalids[k]) {
+			invalids[k] = curve_new();
+			invalids[k]->field = gcopy(original->curve->field);
+			invalids[k]->a = gcopy(original->curve->a);
+		}
+		curve_t *invalid = invalids[k];
+		exhaustive_t invalid_setup = {
+		    .generators = original->setup.generators,
+		    .validators = original->setup.validators,
+		    .gen_argss = invalid_argss,
+		    .unrolls = original->setup.unrolls};
 
-		if (ndivides > 0 &&
-		    exhaustive_gen_retry(invalid, &invalid_setup, OFFSET_GENERATORS,
-		                         OFFSET_POINTS, 1)) {
-			pthread_mutex_lock(thread->mutex_state);
-			pari_ulong primes[ndivides];
-			size_t nprimes = 0;
-			for (size_t i = thread->nprimes; i-- > 0;) {
-				if (dvdis(invalid->order, thread->primes[i]) &&
-				    thread->states[i] == STATE_FREE) {
-					thread->states[i] = STATE_GENERATING;
-					primes[nprimes++] = thread->primes[i];
-					nfree++;
+		pari_sp btop = avma;
+		if (!exhaustive_gen(invalid, &original->setup, OFFSET_B,
+		                    OFFSET_ORDER) &&
+		    timeout_expired()) {
+			order_unroll(invalid, avma, btop);
+			curve_unroll(invalid, avma, btop);
+			avma = btop;
+			break;
+		}
+		if (cfg->prefilter) {
+			/* skip the order if no unclaimed prime divides it */
+			pari_ulong uncovered[original->nprimes];
+			size_t nuncovered = 0;
+			for (size_t i = 0; i < original->nprimes; ++i) {
+				if (atomic_load(&original->states[i]) == STATE_FREE) {
+					uncovered[nuncovered++] = original->primes[i];
 				}
 			}
-			pthread_mutex_unlock(thread->mutex_state);
-
-			if (nfree > 0) {
-				arg_t prime_divisors = {primes, nprimes};
-				invalid_argss[OFFSET_POINTS] = &prime_divisors;
-				exhaustive_gen(invalid, &invalid_setup, OFFSET_POINTS,
-				               OFFSET_END);
-
-				pthread_mutex_lock(thread->mutex_state);
-				size_t count = 0;
-				for (size_t i = thread->nprimes; i-- > 0;) {
-					if (count < nprimes && primes[count] == thread->primes[i]) {
-						thread->states[i] = STATE_GENERATED;
-						thread->curves[i] = curve_new_copy(invalid);
-						count++;
-					}
-				}
-				*(thread->generated) += count;
-				pthread_cond_signal(thread->cond_generated);
-				pthread_mutex_unlock(thread->mutex_state);
+			if (!invalid_screen(invalid, uncovered, nuncovered)) {
+				order_unroll(invalid, avma, btop);
+				curve_unroll(invalid, avma, btop);
+				avma = btop;
+				continue;
 			}
 		}
+		if (!exhaustive_gen(invalid, &original->setup, OFFSET_ORDER,
+		                    OFFSET_GENERATORS) &&
+		    timeout_expired()) {
+			gens_unroll(invalid, avma, btop);
+			order_unroll(invalid, avma, btop);
+			curve_unroll(invalid, avma, btop);
+			avma = btop;
+			break;
+		}
+		invalid_thread_harvest(thread, k, invalid, &invalid_setup);
+		if (cfg->invalid_twists) {
+			invalid_thread_twist(thread, k, invalid, &invalid_setup);
+		}
 
 		points_unroll(invalid, avma, btop);
 		gens_unroll(invalid, avma, btop);
+		order_unroll(invalid, avma, btop);
 		curve_unroll(invalid, avma, btop);
-		if (nfree == 0) avma = btop;
+		avma = btop;
+	}
+	for (size_t i = 0; i < thread->noriginals; ++i) {
+		curve_free(&invalids[i]);
+	}
+	try_free(invalids);
+
+	if (atomic_fetch_sub(thread->running, 1) == 1) {
+		queue_close(thread->results);
 	}
-	curve_free(&invalid);
 
 	pari_thread_close();
 	timeout_thread_quit();
@@ -9,25 +9,90 @@
 #define ECGEN_INVALID_INVALID_THREAD_H
 
 #include <pthread.h>
+#include <stdatomic.h>
 #include "exhaustive/exhaustive.h"
 #include "misc/types.h"
+#include "util/queue.h"
 
 typedef enum { STATE_FREE, STATE_GENERATING, STATE_GENERATED } state_e;
 
+/**
+ * @brief An original curve, with the primes to generate invalid curves for.
+ */
 typedef struct {
-	struct pari_thread *pari_thread;
-	const curve_t *original_curve;
+	curve_t *curve;
+	/* the invalid curve setup, with the template of its field and a */
+	gen_f generators[OFFSET_END];
+	arg_t *gen_argss[OFFSET_END];
+	exhaustive_t setup;
 	size_t nprimes;
 	pari_ulong *primes;
-	state_e *states;
-	curve_t **curves;
-	size_t *generated;
-	pthread_mutex_t *mutex_state;
-	pthread_cond_t *cond_generated;
+	/* claimed by compare-and-swap from STATE_FREE to STATE_GENERATING */
+	_Atomic(state_e) *states;
+	atomic_size_t generated;
+} invalid_original_t;
+
+/**
+ * @brief An invalid curve, serialized by the worker that generated it.
+ * @param original the index of the original curve it is for
+ * @param output the serialized curve
+ * @param nprimes how many of the primes the curve covers, it is output once
+ * for each of them
+ * @param next the next result for the same original, while it waits for its
+ * group to be output
+ */
+typedef struct invalid_result_s {
+	size_t original;
+	char *output;
+	size_t nprimes;
+	struct invalid_result_s *next;
+} invalid_result_t;
+
+typedef struct {
+	struct pari_thread *pari_thread;
+	unsigned long index;
+	invalid_original_t *originals;
+	size_t noriginals;
+	/* the originals with all their primes covered */
+	atomic_size_t *done;
+	/* the workers still running, the last one closes results */
+	atomic_size_t *running;
+	/* of invalid_result_t, for the output thread */
+	queue_t *results;
 	const config_t *cfg;
-	const exhaustive_t *setup;
 } thread_t;
 
+/**
+ * @brief Whether some of the primes might divide the order of the curve,
+ * tested without computing the order, see torsion_divides_any.
+ *
+ * Only screens prime field curves, with primes up to the pre-filter bound.
+ * @param curve
+ * @param primes the primes that are not covered yet
+ * @param nprimes
+ * @return false if the curve can be skipped
+ */
+bool invalid_screen(const curve_t *curve, const pari_ulong *primes,
+                    size_t nprimes);
+
+/**
+ * @brief The quadratic twist of a curve to use as an invalid curve, if the
+ * --invalid-twists mode allows it.
+ *
+ * The twist keeps the a coefficient where it can (see twist_same_a_to),
+ * otherwise only the "any" mode takes a random twist.
+ * @param curve
+ * @return the twist, or NULL if there is none to use
+ */
+curve_t *invalid_twist(const curve_t *curve);
+
+/**
+ * @brief Get the number of curves tested and rejected by invalid_screen.
+ * @param tested
+ * @param rejected
+ */
+void invalid_screen_stats(unsigned long *tested, unsigned long *rejected);
+
 /**
  *
  * @param arg
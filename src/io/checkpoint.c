@@ -0,0 +1,93 @@
+/*
+ * ecgen, tool for generating Elliptic curve domain parameters
+ * Copyright (C) 2017-2018 J08nY
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include "checkpoint.h"
+#include <parson/parson.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "misc/config.h"
+#include "output.h"
+#include "util/memory.h"
+
+bool checkpoint_save(unsigned long emitted) {
+	output_flush();
+	fsync(fileno(out));
+
+	pari_sp ltop = avma;
+	JSON_Value *root_value = json_value_init_object();
+	JSON_Object *root_object = json_value_get_object(root_value);
+	json_object_set_number(root_object, "emitted", emitted);
+	json_object_set_number(root_object, "offset", ftell(out));
+	char *rng = GENtostr(getrand());
+	json_object_set_string(root_object, "rng", rng);
+	pari_free(rng);
+	avma = ltop;
+
+	char *json = json_serialize_to_string_pretty(root_value);
+	json_value_free(root_value);
+
+	size_t len = strlen(cfg->checkpoint);
+	char tmp[len + 5];
+	sprintf(tmp, "%s.tmp", cfg->checkpoint);
+
+	bool result = false;
+	FILE *file = fopen(tmp, "w");
+	if (file) {
+		result = fputs(json, file) >= 0 && fflush(file) == 0 &&
+		         fsync(fileno(file)) == 0;
+		result = fclose(file) == 0 && result;
+		result = result && rename(tmp, cfg->checkpoint) == 0;
+	}
+	if (!result) {
+		perror("Failed to write checkpoint.");
+	}
+	try_free(json);
+	return result;
+}
+
+bool checkpoint_load(checkpoint_t *checkpoint) {
+	JSON_Value *root_value = json_parse_file(cfg->checkpoint);
+	if (!root_value) {
+		fprintf(err, "Failed to read checkpoint %s.\n", cfg->checkpoint);
+		return false;
+	}
+	JSON_Object *root_object = json_value_get_object(root_value);
+	const char *rng = json_object_get_string(root_object, "rng");
+	if (!root_object || !rng ||
+	    !json_object_has_value_of_type(root_object, "emitted", JSONNumber) ||
+	    !json_object_has_value_of_type(root_object, "offset", JSONNumber)) {
+		fprintf(err, "Invalid checkpoint %s.\n", cfg->checkpoint);
+		json_value_free(root_value);
+		return false;
+	}
+
+	checkpoint->emitted =
+	    (unsigned long)json_object_get_number(root_object, "emitted");
+	checkpoint->offset = (long)json_object_get_number(root_object, "offset");
+	checkpoint->rng = try_strdup(rng);
+	json_value_free(root_value);
+	return true;
+}
+
+bool checkpoint_restore(const checkpoint_t *checkpoint) {
+	output_flush();
+	if (fseek(out, checkpoint->offset, SEEK_SET) ||
+	    ftruncate(fileno(out), checkpoint->offset)) {
+		perror("Failed to restore output from checkpoint.");
+		return false;
+	}
+
+	pari_sp ltop = avma;
+	setrand(gp_read_str(checkpoint->rng));
+	avma = ltop;
+	return true;
+}
+
+void checkpoint_free(checkpoint_t *checkpoint) {
+	try_free(checkpoint->rng);
+	checkpoint->rng = NULL;
+}
@@ -0,0 +1,59 @@
+/*
+ * ecgen, tool for generating Elliptic curve domain parameters
+ * Copyright (C) 2017-2018 J08nY
+ */
+/**
+ * @file checkpoint.h
+ */
+#ifndef ECGEN_IO_CHECKPOINT_H
+#define ECGEN_IO_CHECKPOINT_H
+
+#include <pari/pari.h>
+#include <stdbool.h>
+
+/**
+ * @brief Progress of a multi-curve run, enough to resume it.
+ * @param emitted how many curves were written to the output
+ * @param offset the output file offset after the last written curve
+ * @param rng the PARI RNG state (getrand), as a GP string
+ */
+typedef struct {
+	unsigned long emitted;
+	long offset;
+	char *rng;
+} checkpoint_t;
+
+/**
+ * @brief Record the progress into cfg->checkpoint.
+ *
+ * Flushes and syncs the output first, then writes the checkpoint to a
+ * temporary file and renames it over cfg->checkpoint, so that a crash leaves
+ * either the old or the new checkpoint, both consistent with the output.
+ *
+ * @param emitted how many curves were written to the output
+ * @return whether the checkpoint was written
+ */
+bool checkpoint_save(unsigned long emitted);
+
+/**
+ * @brief Load a checkpoint from cfg->checkpoint.
+ * @param checkpoint
+ * @return whether the checkpoint was read
+ */
+bool checkpoint_load(checkpoint_t *checkpoint);
+
+/**
+ * @brief Restore the PARI RNG state and cut the output at the checkpoint
+ * offset, so that generation can continue.
+ * @param checkpoint
+ * @return whether the state was restored
+ */
+bool checkpoint_restore(const checkpoint_t *checkpoint);
+
+/**
+ * @brief Free the contents of a checkpoint.
+ * @param checkpoint
+ */
+void checkpoint_free(checkpoint_t *checkpoint);
+
+#endif  // ECGEN_IO_CHECKPOINT_H
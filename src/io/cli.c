@@ -5,6 +5,7 @@
 #include "cli.h"
 #include <regex.h>
 #include <string.h>
+#include <strings.h>
 #include "exhaustive/ansi.h"
 #include "exhaustive/brainpool.h"
 
@@ -43,6 +44,19 @@ enum opt_keys {
 	OPT_SUPERSINGULAR,
 	OPT_BRAINPOOL_RFC,
 	OPT_TWIST,
+	OPT_ORDERED,
+	OPT_PREFILTER,
+	OPT_STATS,
+	OPT_CHECKPOINT,
+	OPT_RESUME,
+	OPT_RNG_SEED,
+	OPT_FLUSH,
+	OPT_FORMAT,
+	OPT_COLUMNS,
+	OPT_BATCH,
+	OPT_DEADLINE,
+	OPT_INVALID_TWISTS,
+	OPT_INVALID_PLAN,
 };
 
 // clang-format off
@@ -59,6 +73,8 @@ struct argp_option cli_options[] = {
 		{"brainpool",     OPT_BRAINPOOL,     "SEED",  OPTION_ARG_OPTIONAL, "Generate a curve from SEED (Brainpool procedure).",                                    2},
 		{"brainpool-rfc", OPT_BRAINPOOL_RFC, "SEED",  OPTION_ARG_OPTIONAL, "Generate a curve from SEED (Brainpool procedure, as per RFC 5639).",                   2},
 		{"invalid",       OPT_INVALID,       "RANGE", OPTION_ARG_OPTIONAL, "Generate a set of invalid curves, for a given curve (using Invalid curve algorithm).", 2},
+		{"invalid-twists", OPT_INVALID_TWISTS, "any", OPTION_ARG_OPTIONAL, "With --invalid, also output twists keeping a (or any twist).",                         2},
+		{"invalid-plan",  OPT_INVALID_PLAN,  0,       0,                   "With --invalid, generate points on few curves covering many primes.",                  2},
 		{"twist",         OPT_TWIST,         0,       0,                   "Generate a twist of a given curve.",                                                   2},
 
 		{0,               0,                 0,       0,                   "Generation options:",                                                                  3},
@@ -66,26 +82,37 @@ struct argp_option cli_options[] = {
 																		   "Optionally, only generate random parameters WHAT (seed,field,a,b,equation).",          3},
 		{"prime",         OPT_PRIME,         0,       0,                   "Generate a curve with prime order.",                                                   3},
 		{"cofactor",      OPT_COFACTOR,      "VALUE", 0,                   "Generate a curve with cofactor of VALUE.",                                             3},
+		{"prefilter",     OPT_PREFILTER,     "BOUND", OPTION_ARG_OPTIONAL, "Reject curves with a small prime factor (up to BOUND, default 3) in the order early.", 3},
 		{"koblitz",       OPT_KOBLITZ,       "A",     OPTION_ARG_OPTIONAL, "Generate a Koblitz curve (a in {0, 1}, b = 1).",                                       3},
 		{"unique",        OPT_UNIQUE,        0,       0,                   "Generate a curve with only one generator.",                                            3},
 		{"hex-check",     OPT_HEXCHECK,      "HEX",   0,                   "Check a generated curve param hex expansion for the HEX string.",                      3},
-		{"points",        OPT_POINTS,        "TYPE",  0,                   "Generate points of given type (random/prime/all/nonprime/none).",                      3},
+		{"points",        OPT_POINTS,        "TYPE",  0,                   "Generate points of given type (random/prime/all[:MAX]/nonprime[:MAX]/none).",          3},
 		{"count",         OPT_COUNT,         "COUNT", 0,                   "Generate multiple curves.",                                                            3},
 		{"metadata",      OPT_METADATA,      0,       0,                   "Compute curve metadata "
 																		   "(j-invariant, discriminant, trace of Frobenius, embedding degree, CM discriminant).",  3},
 
 		{0,               0,                 0,       0,                   "Input/Output options:",                                                                4},
 		{"input",         OPT_INPUT,         "FILE",  0,                   "Input from file.",                                                                     4},
+		{"batch",         OPT_BATCH,         0,       0,                   "Process every line of the input file as a separate input.",                            4},
 		{"output",        OPT_OUTPUT,        "FILE",  0,                   "Output into file. Overwrites any existing file!",                                      4},
 		{"append",        OPT_APPEND,        0,       0,                   "Append to output file (don't overwrite).",                                             4},
+		{"format",        OPT_FORMAT,        "FORMAT", 0,                  "Output in FORMAT (json/ndjson/binary/csv).",                                           4},
+		{"columns",       OPT_COLUMNS,       "LIST",  0,                   "Output the comma separated LIST of columns in the csv format.",                        4},
+		{"flush",         OPT_FLUSH,         "WHEN",  0,                   "Flush the output after every record, every N records or on exit (record/N/exit).",     4},
+		{"checkpoint",    OPT_CHECKPOINT,    "FILE",  0,                   "Record progress into FILE after every curve written to the output file.",              4},
+		{"resume",        OPT_RESUME,        0,       0,                   "Resume a run from the --checkpoint FILE.",                                             4},
+		{"stats",         OPT_STATS,         "FILE",  OPTION_ARG_OPTIONAL, "Output per state generation statistics as JSON (to verbose output or file).",          4},
 		{"verbose",       OPT_VERBOSE,       "FILE",  OPTION_ARG_OPTIONAL, "Verbose logging (to stdout or file).",                                                 4},
 
 		{0,               0,                 0,       0,                   "Other:",                                                                               5},
 		{"data-dir",      OPT_DATADIR,       "DIR",   0,                   "Set PARI/GP data directory (containing seadata package).",                             5},
 		{"memory",        OPT_MEMORY,        "SIZE",  0,                   "Use PARI stack of SIZE (can have suffix k/m/g).",                                      5},
+		{"rng-seed",      OPT_RNG_SEED,      "HEX",   0,                   "Seed the random generators from HEX, for reproducible runs.",                          5},
 		{"threads",       OPT_THREADS,       "NUM",   0,                   "Use NUM threads.",                                                                     5},
 		{"thread-stack",  OPT_TSTACK,        "SIZE",  0,                   "Use PARI stack of SIZE (per thread, can have suffix k/m/g).",                          5},
-		{"timeout",       OPT_TIMEOUT,       "TIME",  0,                   "Timeout computation of a curve parameter after TIME (can have suffix s/m/h/d).",       5},
+		{"ordered",       OPT_ORDERED,       0,       0,                   "Output curves generated by multiple threads in order, not as they finish.",            5},
+		{"timeout",       OPT_TIMEOUT,       "TIME",  0,                   "Timeout computation of a curve parameter after TIME (s/m/h/d), or STATE:TIME,...",     5},
+		{"deadline",      OPT_DEADLINE,      "TIME",  0,                   "Stop the run after TIME (can have suffix s/m/h/d), outputting the curves so far.",     5},
 		{0}
 };
 // clang-format on
@@ -145,6 +172,77 @@ static unsigned long cli_parse_time(const char *str, struct argp_state *state) {
 	return read;
 }
 
+static void cli_parse_timeout(const char *arg, struct argp_state *state) {
+	bool set[OFFSET_END] = {false};
+	unsigned long all = 0;
+	const char *item = arg;
+	while (*item) {
+		size_t len = strcspn(item, ",");
+		const char *colon = memchr(item, ':', len);
+		if (colon) {
+			size_t name_len = (size_t)(colon - item);
+			size_t i;
+			for (i = 0; i < OFFSET_END; ++i) {
+				if (strlen(offset_s[i]) == name_len &&
+				    !strncasecmp(item, offset_s[i], name_len)) {
+					break;
+				}
+			}
+			if (i == OFFSET_END) {
+				argp_failure(state, 1, 0, "Unknown state %.*s in timeout.",
+				             (int)name_len, item);
+				return;
+			}
+			cfg->timeout[i] = cli_parse_time(colon + 1, state);
+			set[i] = true;
+		} else {
+			all = cli_parse_time(item, state);
+		}
+		item += len;
+		if (*item == ',') item++;
+	}
+	// a TIME without a state applies to all the other states
+	for (size_t i = 0; i < OFFSET_END; ++i) {
+		if (!set[i]) {
+			cfg->timeout[i] = all;
+		}
+	}
+}
+
+static size_t cli_parse_points_max(const char *type,
+                                   struct argp_state *state) {
+	const char *max = strchr(type, ':');
+	if (!max) {
+		return 0;
+	}
+	char *max_end;
+	long value = strtol(max + 1, &max_end, 10);
+	if (value <= 0 || *max_end) {
+		argp_failure(state, 1, 0, "Points maximum not a positive number. %s",
+		             max + 1);
+	}
+	return (size_t)value;
+}
+
+static char *cli_parse_hex(char *arg, const char *what,
+                           struct argp_state *state) {
+	char *str_start = arg;
+	if (strlen(arg) > 2) {
+		if (arg[0] == '0' && (arg[1] == 'x' || arg[1] == 'X')) {
+			str_start = arg + 2;
+		}
+	}
+	char *p = str_start;
+	while (*p != 0) {
+		char c = *p++;
+		if (!isxdigit(c)) {
+			argp_failure(state, 1, 0, "%s argument contains non hex char '%c'",
+			             what, c);
+		}
+	}
+	return str_start;
+}
+
 static void cli_end(struct argp_state *state) {
 	// validate all option states here.
 	// Only one field
@@ -184,6 +282,61 @@ static void cli_end(struct argp_state *state) {
 		             "Can only generate supersingular curves over prime fields "
 		             "currently.");
 	}
+	if (cfg->checkpoint &&
+	    (cfg->method != METHOD_DEFAULT && cfg->method != METHOD_SEED)) {
+		argp_failure(state, 1, 0,
+		             "Checkpoints are only supported by the Random and seed "
+		             "methods.");
+	}
+	if (cfg->checkpoint && !cfg->output) {
+		argp_failure(state, 1, 0, "Checkpoints need an --output file.");
+	}
+	if (cfg->stats &&
+	    (cfg->method == METHOD_CM || cfg->method == METHOD_ANOMALOUS ||
+	     cfg->method == METHOD_SUPERSINGULAR ||
+	     cfg->method == METHOD_INVALID)) {
+		argp_failure(state, 1, 0,
+		             "Statistics are not supported by the CM, anomalous, "
+		             "supersingular and invalid methods.");
+	}
+	if (cfg->resume && !cfg->checkpoint) {
+		argp_failure(state, 1, 0, "Resuming needs a --checkpoint file.");
+	}
+	if (cfg->prefilter &&
+	    !(cfg->prime || cfg->cofactor || cfg->method == METHOD_INVALID)) {
+		argp_failure(
+		    state, 1, 0,
+		    "Pre-filter only applies with --prime, --cofactor or --invalid.");
+	}
+	if (cfg->prefilter && cfg->field != FIELD_PRIME) {
+		argp_failure(state, 1, 0, "Pre-filter only applies to prime fields.");
+	}
+	if (cfg->prefilter &&
+	    (cfg->method == METHOD_CM || cfg->method == METHOD_ANOMALOUS ||
+	     cfg->method == METHOD_SUPERSINGULAR)) {
+		argp_failure(state, 1, 0,
+		             "Pre-filter is not supported by the CM, anomalous and "
+		             "supersingular methods.");
+	}
+	if (cfg->invalid_twists && cfg->method != METHOD_INVALID) {
+		argp_failure(state, 1, 0, "Invalid twists only apply with --invalid.");
+	}
+	if (cfg->invalid_plan && cfg->method != METHOD_INVALID) {
+		argp_failure(state, 1, 0, "Invalid plan only applies with --invalid.");
+	}
+	if (cfg->invalid_plan && cfg->threads > 1) {
+		argp_failure(state, 1, 0, "Invalid plan only runs in one thread.");
+	}
+	if (cfg->batch && !cfg->input) {
+		argp_failure(state, 1, 0, "Batch mode needs an --input file.");
+	}
+	if (cfg->batch && cfg->checkpoint) {
+		argp_failure(state, 1, 0,
+		             "Checkpoints are not supported in batch mode.");
+	}
+	if (cfg->columns && cfg->format != FORMAT_CSV) {
+		argp_failure(state, 1, 0, "Columns only apply with --format=csv.");
+	}
 	// default values
 	if (!cfg->count) {
 		cfg->count = 1;
@@ -197,7 +350,14 @@ static void cli_end(struct argp_state *state) {
 	if (!cfg->thread_memory) {
 		cfg->thread_memory = cfg->bits * 2000000;
 	}
-	cfg->format = FORMAT_JSON;
+	/*
+	 * The checkpoint only records how many curves were written, a seeded run
+	 * resumes from that index, so the curves before it have to be the ones
+	 * written.
+	 */
+	if (cfg->rng_seed && cfg->checkpoint) {
+		cfg->ordered = true;
+	}
 }
 
 error_t cli_parse(int key, char *arg, struct argp_state *state) {
@@ -221,6 +381,18 @@ error_t cli_parse(int key, char *arg, struct argp_state *state) {
 				cfg->invalid_primes = arg;
 			}
 			break;
+		case OPT_INVALID_TWISTS:
+			cfg->invalid_twists = TWISTS_SAME_A;
+			if (arg) {
+				if (strcmp(arg, "any") != 0) {
+					argp_failure(state, 1, 0, "Invalid twists %s", arg);
+				}
+				cfg->invalid_twists = TWISTS_ANY;
+			}
+			break;
+		case OPT_INVALID_PLAN:
+			cfg->invalid_plan = true;
+			break;
 		case OPT_ORDER:
 			cfg->method |= METHOD_CM;
 			if (arg) {
@@ -312,6 +484,17 @@ error_t cli_parse(int key, char *arg, struct argp_state *state) {
 			cfg->cofactor = true;
 			cfg->cofactor_value = strtol(arg, NULL, 10);
 			break;
+		case OPT_PREFILTER:
+			cfg->prefilter = true;
+			cfg->prefilter_bound = 3;
+			if (arg) {
+				cfg->prefilter_bound = strtoul(arg, NULL, 10);
+				if (cfg->prefilter_bound < 2) {
+					argp_failure(state, 1, 0, "Wrong value for bound = %s",
+					             arg);
+				}
+			}
+			break;
 		case OPT_KOBLITZ:
 			cfg->koblitz = true;
 			if (arg) {
@@ -325,25 +508,9 @@ error_t cli_parse(int key, char *arg, struct argp_state *state) {
 		case OPT_UNIQUE:
 			cfg->unique = true;
 			break;
-		case OPT_HEXCHECK: {
-			char *str_start = arg;
-			if (strlen(arg) > 2) {
-				if (arg[0] == '0' && (arg[1] == 'x' || arg[1] == 'X')) {
-					str_start = arg + 2;
-				}
-			}
-			char *p = str_start;
-			while (*p != 0) {
-				char c = *p++;
-				if (!isxdigit(c)) {
-					argp_failure(
-					    state, 1, 0,
-					    "Hex check argument contains non hex char '%c'", c);
-				}
-			}
-			cfg->hex_check = str_start;
+		case OPT_HEXCHECK:
+			cfg->hex_check = cli_parse_hex(arg, "Hex check", state);
 			break;
-		}
 		case OPT_METADATA:
 			cfg->metadata = true;
 			break;
@@ -357,8 +524,10 @@ error_t cli_parse(int key, char *arg, struct argp_state *state) {
 				cfg->points.type = POINTS_PRIME;
 			} else if (strstr(num_end, "all") == num_end) {
 				cfg->points.type = POINTS_ALL;
+				cfg->points.amount = cli_parse_points_max(num_end, state);
 			} else if (strstr(num_end, "nonprime") == num_end) {
 				cfg->points.type = POINTS_NONPRIME;
+				cfg->points.amount = cli_parse_points_max(num_end, state);
 			} else if (strstr(num_end, "none") == num_end) {
 				cfg->points.type = POINTS_NONE;
 			} else {
@@ -373,9 +542,55 @@ error_t cli_parse(int key, char *arg, struct argp_state *state) {
 		case OPT_OUTPUT:
 			cfg->output = arg;
 			break;
+		case OPT_BATCH:
+			cfg->batch = true;
+			break;
 		case OPT_APPEND:
 			cfg->append = true;
 			break;
+		case OPT_FORMAT:
+			if (!strcmp(arg, "json")) {
+				cfg->format = FORMAT_JSON;
+			} else if (!strcmp(arg, "ndjson")) {
+				cfg->format = FORMAT_NDJSON;
+			} else if (!strcmp(arg, "binary")) {
+				cfg->format = FORMAT_BINARY;
+			} else if (!strcmp(arg, "csv")) {
+				cfg->format = FORMAT_CSV;
+			} else {
+				argp_failure(state, 1, 0, "Unknown format %s", arg);
+			}
+			break;
+		case OPT_COLUMNS:
+			cfg->columns = arg;
+			break;
+		case OPT_FLUSH:
+			if (!strcmp(arg, "record")) {
+				cfg->flush = FLUSH_RECORD;
+			} else if (!strcmp(arg, "exit")) {
+				cfg->flush = FLUSH_EXIT;
+			} else {
+				char *end = NULL;
+				cfg->flush = FLUSH_EVERY;
+				cfg->flush_every = strtoul(arg, &end, 10);
+				if (*end != '\0' || !cfg->flush_every) {
+					argp_failure(state, 1, 0, "Wrong value for flush = %s",
+					             arg);
+				}
+			}
+			break;
+		case OPT_CHECKPOINT:
+			cfg->checkpoint = arg;
+			break;
+		case OPT_RESUME:
+			cfg->resume = true;
+			break;
+		case OPT_STATS:
+			cfg->stats = true;
+			if (arg) {
+				cfg->stats_file = arg;
+			}
+			break;
 		case OPT_VERBOSE:
 			cfg->verbose++;
 			if (arg) {
@@ -390,11 +605,26 @@ error_t cli_parse(int key, char *arg, struct argp_state *state) {
 		case OPT_MEMORY:
 			cfg->memory = cli_parse_memory(arg, state);
 			break;
+		case OPT_RNG_SEED:
+			cfg->rng_seed = cli_parse_hex(arg, "RNG seed", state);
+			if (!*cfg->rng_seed) {
+				argp_failure(state, 1, 0, "RNG seed argument is empty.");
+			}
+			break;
 		case OPT_TSTACK:
 			cfg->thread_memory = cli_parse_memory(arg, state);
 			break;
+		case OPT_ORDERED:
+			cfg->ordered = true;
+			break;
 		case OPT_TIMEOUT:
-			cfg->timeout = cli_parse_time(arg, state);
+			cli_parse_timeout(arg, state);
+			break;
+		case OPT_DEADLINE:
+			cfg->deadline = cli_parse_time(arg, state);
+			if (!cfg->deadline) {
+				argp_failure(state, 1, 0, "Deadline has to be positive.");
+			}
 			break;
 		case OPT_THREADS:
 			if (!strcmp(arg, "auto") || !strcmp(arg, "AUTO")) {
@@ -5,11 +5,24 @@
 #define _POSIX_C_SOURCE 200809L
 
 #include "input.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "output.h"
+#include "util/memory.h"
 
 FILE *in;
 int delim;
 
+/**
+ * @brief The whole input file in batch mode, mapped or read into memory.
+ */
+static char *batch_data = NULL;
+static size_t batch_len = 0;
+static size_t batch_pos = 0;
+static bool batch_mapped = false;
+
 static GEN input_i(const char *prompt, unsigned long bits) {
 	if (prompt && in == stdin) {
 		fprintf(err, "%s ", prompt);
@@ -91,7 +104,87 @@ GEN input_string(const char *prompt) {
 	return result;
 }
 
+static bool input_batch_read(int fd) {
+	size_t capacity = 0;
+	ssize_t got;
+	do {
+		if (batch_len == capacity) {
+			capacity = capacity ? capacity * 2 : 4096;
+			batch_data = try_realloc(batch_data, capacity);
+		}
+		got = read(fd, batch_data + batch_len, capacity - batch_len);
+		if (got > 0) {
+			batch_len += got;
+		}
+	} while (got > 0);
+	if (got < 0) {
+		perror("Failed to read input file.");
+		return false;
+	}
+	return true;
+}
+
+static bool input_batch_init() {
+	int fd = open(cfg->input, O_RDONLY);
+	if (fd < 0) {
+		perror("Failed to open input file.");
+		return false;
+	}
+	struct stat st;
+	bool result = true;
+	if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+		batch_data =
+		    mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (batch_data != MAP_FAILED) {
+			batch_len = (size_t)st.st_size;
+			batch_mapped = true;
+			posix_madvise(batch_data, batch_len, POSIX_MADV_SEQUENTIAL);
+		} else {
+			batch_data = NULL;
+			result = input_batch_read(fd);
+		}
+	} else {
+		// pipes and the like can not be mapped
+		result = input_batch_read(fd);
+	}
+	close(fd);
+	in = NULL;
+	delim = ',';
+	return result;
+}
+
+bool input_next(void) {
+	if (in) {
+		fclose(in);
+		in = NULL;
+	}
+	while (batch_pos < batch_len) {
+		size_t start = batch_pos;
+		char *end = memchr(batch_data + start, '\n', batch_len - start);
+		// the record keeps its newline, just like a single record file
+		batch_pos = end ? (size_t)(end - batch_data) + 1 : batch_len;
+
+		bool blank = true;
+		for (size_t i = start; i < batch_pos && blank; ++i) {
+			blank = isspace((unsigned char)batch_data[i]);
+		}
+		if (blank) {
+			continue;
+		}
+		in = fmemopen(batch_data + start, batch_pos - start, "r");
+		if (!in) {
+			perror("Failed to open input record.");
+			return false;
+		}
+		return true;
+	}
+	return false;
+}
+
 bool input_init() {
+	if (cfg->batch) {
+		return input_batch_init();
+	}
 	if (cfg->input) {
 		in = fopen(cfg->input, "r");
 		delim = ',';
@@ -110,4 +203,13 @@ void input_quit(void) {
 	if (in != NULL && in != stdin) {
 		fclose(in);
 	}
+	in = NULL;
+	if (batch_mapped) {
+		munmap(batch_data, batch_len);
+	} else {
+		try_free(batch_data);
+	}
+	batch_data = NULL;
+	batch_len = batch_pos = 0;
+	batch_mapped = false;
 }
@@ -52,6 +52,16 @@ extern FILE *in;
  */
 bool input_init();
 
+/**
+ * @brief Advance to the next record of the input file, in batch mode.
+ *
+ * The records are the non-blank lines of the input file, <code>in</code> reads
+ * from the current record.
+ *
+ * @return whether there is a next record
+ */
+bool input_next(void);
+
 /**
  * @brief Deinitialize input.
  */
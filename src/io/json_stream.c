@@ -0,0 +1,161 @@
+/*
+ * ecgen, tool for generating Elliptic curve domain parameters
+ * Copyright (C) 2017-2018 J08nY
+ */
+#include "json_stream.h"
+#include <stdio.h>
+#include <string.h>
+#include "util/memory.h"
+
+static void json_stream_append(json_stream_t *stream, const char *what,
+                               size_t len) {
+	if (stream->len + len + 1 > stream->capacity) {
+		size_t capacity = stream->capacity ? stream->capacity : 256;
+		while (stream->len + len + 1 > capacity) {
+			capacity *= 2;
+		}
+		stream->data = try_realloc(stream->data, capacity);
+		stream->capacity = capacity;
+	}
+	memcpy(stream->data + stream->len, what, len);
+	stream->len += len;
+	stream->data[stream->len] = '\0';
+}
+
+static void json_stream_puts(json_stream_t *stream, const char *what) {
+	json_stream_append(stream, what, strlen(what));
+}
+
+static void json_stream_indent(json_stream_t *stream, size_t level) {
+	for (size_t i = 0; i < level; ++i) {
+		json_stream_append(stream, "    ", 4);
+	}
+}
+
+/* Separates the next value from the previous one in its object or array. */
+static void json_stream_next(json_stream_t *stream) {
+	if (stream->keyed) {
+		stream->keyed = false;
+		return;
+	}
+	if (stream->depth == 0) {
+		return;
+	}
+	if (stream->counts[stream->depth - 1]++) {
+		json_stream_append(stream, ",", 1);
+	}
+	if (stream->pretty) {
+		json_stream_append(stream, "\n", 1);
+		json_stream_indent(stream, stream->depth);
+	}
+}
+
+static void json_stream_quoted(json_stream_t *stream, const char *string) {
+	json_stream_append(stream, "\"", 1);
+	const char *start = string;
+	for (const char *c = string; *c; ++c) {
+		const char *escaped = NULL;
+		char unicode[7];
+		switch (*c) {
+			case '\"':
+				escaped = "\\\"";
+				break;
+			case '\\':
+				escaped = "\\\\";
+				break;
+			case '/':
+				escaped = "\\/";
+				break;
+			case '\b':
+				escaped = "\\b";
+				break;
+			case '\f':
+				escaped = "\\f";
+				break;
+			case '\n':
+				escaped = "\\n";
+				break;
+			case '\r':
+				escaped = "\\r";
+				break;
+			case '\t':
+				escaped = "\\t";
+				break;
+			default:
+				if ((unsigned char)*c < 0x20) {
+					sprintf(unicode, "\\u%04x", (unsigned char)*c);
+					escaped = unicode;
+				}
+				break;
+		}
+		if (escaped) {
+			json_stream_append(stream, start, (size_t)(c - start));
+			json_stream_puts(stream, escaped);
+			start = c + 1;
+		}
+	}
+	json_stream_puts(stream, start);
+	json_stream_append(stream, "\"", 1);
+}
+
+static void json_stream_open(json_stream_t *stream, const char *bracket) {
+	json_stream_next(stream);
+	json_stream_puts(stream, bracket);
+	stream->counts[stream->depth++] = 0;
+}
+
+static void json_stream_close(json_stream_t *stream, const char *bracket) {
+	if (stream->counts[--stream->depth] && stream->pretty) {
+		json_stream_append(stream, "\n", 1);
+		json_stream_indent(stream, stream->depth);
+	}
+	json_stream_puts(stream, bracket);
+}
+
+void json_stream_init(json_stream_t *stream, bool pretty) {
+	memset(stream, 0, sizeof(json_stream_t));
+	stream->pretty = pretty;
+	json_stream_append(stream, "", 0);
+}
+
+char *json_stream_finish(json_stream_t *stream) {
+	char *result = stream->data;
+	stream->data = NULL;
+	stream->len = 0;
+	stream->capacity = 0;
+	return result;
+}
+
+void json_stream_key(json_stream_t *stream, const char *key) {
+	json_stream_next(stream);
+	json_stream_quoted(stream, key);
+	json_stream_puts(stream, stream->pretty ? ": " : ":");
+	stream->keyed = true;
+}
+
+void json_stream_object_begin(json_stream_t *stream) {
+	json_stream_open(stream, "{");
+}
+
+void json_stream_object_end(json_stream_t *stream) {
+	json_stream_close(stream, "}");
+}
+
+void json_stream_array_begin(json_stream_t *stream) {
+	json_stream_open(stream, "[");
+}
+
+void json_stream_array_end(json_stream_t *stream) {
+	json_stream_close(stream, "]");
+}
+
+void json_stream_string(json_stream_t *stream, const char *string) {
+	json_stream_next(stream);
+	json_stream_quoted(stream, string);
+}
+
+void json_stream_key_string(json_stream_t *stream, const char *key,
+                            const char *string) {
+	json_stream_key(stream, key);
+	json_stream_string(stream, string);
+}
@@ -0,0 +1,104 @@
+/*
+ * ecgen, tool for generating Elliptic curve domain parameters
+ * Copyright (C) 2017-2018 J08nY
+ */
+/**
+ * @file json_stream.h
+ */
+#ifndef ECGEN_IO_JSON_STREAM_H
+#define ECGEN_IO_JSON_STREAM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define JSON_STREAM_DEPTH 16
+
+/**
+ * @brief A JSON writer that appends straight into a string buffer.
+ *
+ * Produces byte for byte the same output as serializing the same values
+ * through the parson DOM, either pretty or compact, without building the
+ * tree first.
+ *
+ * @param data the output so far, NUL terminated
+ * @param len length of data
+ * @param capacity allocated size of data
+ * @param pretty whether to output like json_serialize_to_string_pretty
+ * @param depth how many objects and arrays are open
+ * @param counts how many values each open object or array has
+ * @param keyed whether a key was just written, so the next value belongs to
+ * it
+ */
+typedef struct {
+	char *data;
+	size_t len;
+	size_t capacity;
+	bool pretty;
+	size_t depth;
+	size_t counts[JSON_STREAM_DEPTH];
+	bool keyed;
+} json_stream_t;
+
+/**
+ * @brief Initialize a stream.
+ * @param stream
+ * @param pretty
+ */
+void json_stream_init(json_stream_t *stream, bool pretty);
+
+/**
+ * @brief Take the output of the stream, the stream can then only be
+ * initialized again.
+ * @param stream
+ * @return the output, should be freed with try_free
+ */
+char *json_stream_finish(json_stream_t *stream);
+
+/**
+ * @brief Write an object key, the next value belongs to it.
+ * @param stream
+ * @param key
+ */
+void json_stream_key(json_stream_t *stream, const char *key);
+
+/**
+ * @brief Open an object.
+ * @param stream
+ */
+void json_stream_object_begin(json_stream_t *stream);
+
+/**
+ * @brief Close the innermost object.
+ * @param stream
+ */
+void json_stream_object_end(json_stream_t *stream);
+
+/**
+ * @brief Open an array.
+ * @param stream
+ */
+void json_stream_array_begin(json_stream_t *stream);
+
+/**
+ * @brief Close the innermost array.
+ * @param stream
+ */
+void json_stream_array_end(json_stream_t *stream);
+
+/**
+ * @brief Write a string value.
+ * @param stream
+ * @param string
+ */
+void json_stream_string(json_stream_t *stream, const char *string);
+
+/**
+ * @brief Write a key and a string value.
+ * @param stream
+ * @param key
+ * @param string
+ */
+void json_stream_key_string(json_stream_t *stream, const char *key,
+                            const char *string);
+
+#endif  // ECGEN_IO_JSON_STREAM_H
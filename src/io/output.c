@@ -5,9 +5,55 @@
 
 #include "output.h"
 #include <parson/parson.h>
+#include <pthread.h>
 #include "gen/field.h"
+#include "json_stream.h"
 #include "util/bits.h"
 #include "util/memory.h"
+#include "util/queue.h"
+
+/**
+ * @brief A piece of output, waiting for the writer thread.
+ * @param data what to write, NULL for a flush request
+ * @param len length of data
+ * @param record whether this is a whole record (a curve), for the flush policy
+ */
+typedef struct {
+	char *data;
+	size_t len;
+	bool record;
+} output_item_t;
+
+/**
+ * @brief A growing buffer for a record being serialized.
+ */
+typedef struct {
+	unsigned char *data;
+	size_t len;
+	size_t capacity;
+} output_bytes_t;
+
+static size_t output_length(const char *s, bool record) {
+	if (record && cfg->format == FORMAT_BINARY) {
+		// binary records start with their big-endian length
+		const unsigned char *u = (const unsigned char *)s;
+		return 4 + ((size_t)u[0] << 24 | (size_t)u[1] << 16 |
+		            (size_t)u[2] << 8 | (size_t)u[3]);
+	}
+	return strlen(s);
+}
+
+#define OUTPUT_BUFFER_SIZE (1 << 20)
+#define OUTPUT_QUEUE_SIZE 64
+
+static queue_t *output_queue = NULL;
+static pthread_t output_writer;
+/* Stays attached to out until exit, which might be stdout. */
+static char output_buffer[OUTPUT_BUFFER_SIZE];
+static pthread_mutex_t output_flush_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t output_flush_cond = PTHREAD_COND_INITIALIZER;
+static unsigned long output_flush_requested = 0;
+static unsigned long output_flush_done = 0;
 
 char *(*output_s)(curve_t *curve);
 char *(*output_s_separator)();
@@ -24,40 +70,53 @@ char *output_malloc(const char *what) {
 	return s;
 }
 
-static JSON_Value *output_json_point(point_t *point) {
-	JSON_Value *point_value = json_value_init_object();
-	JSON_Object *point_object = json_value_get_object(point_value);
+/* Leaves the point object open, so that a subgroup can add its points. */
+static void output_json_point_begin(json_stream_t *stream, point_t *point) {
+	json_stream_object_begin(stream);
 
 	char *x = pari_sprintf("%P0#*x", cfg->hex_digits,
 	                       field_elementi(gel(point->point, 1)));
-	json_object_set_string(point_object, "x", x);
+	json_stream_key_string(stream, "x", x);
 	pari_free(x);
 	char *y = pari_sprintf("%P0#*x", cfg->hex_digits,
 	                       field_elementi(gel(point->point, 2)));
-	json_object_set_string(point_object, "y", y);
+	json_stream_key_string(stream, "y", y);
 	pari_free(y);
 	char *p_order = pari_sprintf("%P#x", point->order);
-	json_object_set_string(point_object, "order", p_order);
+	json_stream_key_string(stream, "order", p_order);
 	pari_free(p_order);
 	if (point->cofactor) {
 		char *cofactor = pari_sprintf("%P#x", point->cofactor);
-		json_object_set_string(point_object, "cofactor", cofactor);
+		json_stream_key_string(stream, "cofactor", cofactor);
 		pari_free(cofactor);
 	}
+}
 
-	return point_value;
+static void output_json_meta(json_stream_t *stream, const char *key, GEN value,
+                             bool *open) {
+	if (value == NULL) return;
+	if (!*open) {
+		json_stream_key(stream, "meta");
+		json_stream_object_begin(stream);
+		*open = true;
+	}
+	char *str = pari_sprintf("%Pi", value);
+	json_stream_key_string(stream, key, str);
+	pari_free(str);
 }
 
-static JSON_Value *output_jjson(curve_t *curve) {
+static void output_json(json_stream_t *stream, curve_t *curve) {
 	pari_sp ltop = avma;
-	// root object/value is curve
-	JSON_Value *root_value = json_value_init_object();
-	JSON_Object *root_object = json_value_get_object(root_value);
+	// root object is curve
+	json_stream_object_begin(stream);
 
 	switch (cfg->field) {
 		case FIELD_PRIME: {
 			char *prime = pari_sprintf("%P0#*x", cfg->hex_digits, curve->field);
-			json_object_dotset_string(root_object, "field.p", prime);
+			json_stream_key(stream, "field");
+			json_stream_object_begin(stream);
+			json_stream_key_string(stream, "p", prime);
+			json_stream_object_end(stream);
 			pari_free(prime);
 			break;
 		}
@@ -67,10 +126,13 @@ static JSON_Value *output_jjson(curve_t *curve) {
 			char *e1 = pari_sprintf("%P#x", gel(field, 2));
 			char *e2 = pari_sprintf("%P#x", gel(field, 3));
 			char *e3 = pari_sprintf("%P#x", gel(field, 4));
-			json_object_dotset_string(root_object, "field.m", m);
-			json_object_dotset_string(root_object, "field.e1", e1);
-			json_object_dotset_string(root_object, "field.e2", e2);
-			json_object_dotset_string(root_object, "field.e3", e3);
+			json_stream_key(stream, "field");
+			json_stream_object_begin(stream);
+			json_stream_key_string(stream, "m", m);
+			json_stream_key_string(stream, "e1", e1);
+			json_stream_key_string(stream, "e2", e2);
+			json_stream_key_string(stream, "e3", e3);
+			json_stream_object_end(stream);
 			pari_free(m);
 			pari_free(e1);
 			pari_free(e2);
@@ -87,109 +149,477 @@ static JSON_Value *output_jjson(curve_t *curve) {
 		hex[0] = '0';
 		hex[1] = 'x';
 		strcat(hex, hex_str);
-		json_object_set_string(root_object, "seed", hex);
+		json_stream_key_string(stream, "seed", hex);
 		try_free(hex_str);
 		try_free(hex);
 	}
 
 	char *a = pari_sprintf("%P0#*x", cfg->hex_digits, field_elementi(curve->a));
-	json_object_set_string(root_object, "a", a);
+	json_stream_key_string(stream, "a", a);
 	pari_free(a);
 	char *b = pari_sprintf("%P0#*x", cfg->hex_digits, field_elementi(curve->b));
-	json_object_set_string(root_object, "b", b);
+	json_stream_key_string(stream, "b", b);
 	pari_free(b);
 	char *order = pari_sprintf("%P0#*x", cfg->hex_digits, curve->order);
-	json_object_set_string(root_object, "order", order);
+	json_stream_key_string(stream, "order", order);
 	pari_free(order);
 	if (curve->ngens) {
-		JSON_Value *gens_value = json_value_init_array();
-		JSON_Array *gens_array = json_value_get_array(gens_value);
+		json_stream_key(stream, "subgroups");
+		json_stream_array_begin(stream);
 
 		for (size_t i = 0; i < curve->ngens; ++i) {
-			JSON_Value *gen_value =
-			    output_json_point(curve->generators[i]->generator);
-			JSON_Object *gen_object = json_value_get_object(gen_value);
+			output_json_point_begin(stream,
+			                        curve->generators[i]->generator);
 
 			if (curve->generators[i]->npoints) {
-				JSON_Value *gens_points_value = json_value_init_array();
-				JSON_Array *gens_points_array =
-				    json_value_get_array(gens_points_value);
+				json_stream_key(stream, "points");
+				json_stream_array_begin(stream);
 				for (size_t j = 0; j < curve->generators[i]->npoints; ++j) {
-					json_array_append_value(
-					    gens_points_array,
-					    output_json_point(curve->generators[i]->points[j]));
+					output_json_point_begin(stream,
+					                        curve->generators[i]->points[j]);
+					json_stream_object_end(stream);
 				}
-				json_object_set_value(gen_object, "points", gens_points_value);
+				json_stream_array_end(stream);
 			}
-			json_array_append_value(gens_array, gen_value);
+			json_stream_object_end(stream);
 		}
-		json_object_set_value(root_object, "subgroups", gens_value);
+		json_stream_array_end(stream);
 	}
 	if (cfg->metadata) {
-		if (curve->meta.j_invariant != NULL) {
-			char *j = pari_sprintf("%Pi", curve->meta.j_invariant);
-			json_object_dotset_string(root_object, "meta.j", j);
-			pari_free(j);
+		// like the other values, meta is only there if it has something
+		bool open = false;
+		output_json_meta(stream, "j", curve->meta.j_invariant, &open);
+		output_json_meta(stream, "discriminant", curve->meta.discriminant,
+		                 &open);
+		output_json_meta(stream, "embedding_degree",
+		                 curve->meta.embedding_degree, &open);
+		output_json_meta(stream, "frobenius", curve->meta.frobenius_trace,
+		                 &open);
+		output_json_meta(stream, "cm_discriminant",
+		                 curve->meta.cm_discriminant, &open);
+		output_json_meta(stream, "conductor", curve->meta.conductor, &open);
+		if (open) {
+			json_stream_object_end(stream);
 		}
-		if (curve->meta.discriminant != NULL) {
-			char *disc = pari_sprintf("%Pi", curve->meta.discriminant);
-			json_object_dotset_string(root_object, "meta.discriminant", disc);
-			pari_free(disc);
+	}
+
+	json_stream_object_end(stream);
+	avma = ltop;
+}
+
+char *output_sjson(curve_t *curve) {
+	json_stream_t stream;
+	json_stream_init(&stream, true);
+	output_json(&stream, curve);
+	return json_stream_finish(&stream);
+}
+
+char *output_sndjson(curve_t *curve) {
+	json_stream_t stream;
+	json_stream_init(&stream, false);
+	output_json(&stream, curve);
+	char *result = json_stream_finish(&stream);
+	size_t len = strlen(result);
+	result = try_realloc(result, len + 2);
+	strcpy(result + len, "\n");
+	return result;
+}
+
+char *output_sndjson_separator() { return NULL; }
+
+char *output_sndjson_begin() { return NULL; }
+
+char *output_sndjson_end() { return NULL; }
+
+static void output_bytes_put(output_bytes_t *bin, const void *what,
+                             size_t len) {
+	if (bin->len + len > bin->capacity) {
+		size_t capacity = bin->capacity ? bin->capacity : 256;
+		while (bin->len + len > capacity) {
+			capacity *= 2;
 		}
-		if (curve->meta.embedding_degree != NULL) {
-			char *embedding_degree =
-			    pari_sprintf("%Pi", curve->meta.embedding_degree);
-			json_object_dotset_string(root_object, "meta.embedding_degree",
-			                          embedding_degree);
-			pari_free(embedding_degree);
+		bin->data = try_realloc(bin->data, capacity);
+		bin->capacity = capacity;
+	}
+	if (len) {
+		memcpy(bin->data + bin->len, what, len);
+		bin->len += len;
+	}
+}
+
+static void output_binary_u32(output_bytes_t *bin, size_t value) {
+	unsigned char bytes[4] = {(unsigned char)(value >> 24),
+	                          (unsigned char)(value >> 16),
+	                          (unsigned char)(value >> 8), (unsigned char)value};
+	output_bytes_put(bin, bytes, 4);
+}
+
+static void output_binary_int(output_bytes_t *bin, GEN value) {
+	pari_sp ltop = avma;
+	size_t len = signe(value) ? (size_t)(expi(value) / 8 + 1) : 0;
+	unsigned char bytes[len ? len : 1];
+	GEN rest = value;
+	for (size_t i = len; i-- > 0;) {
+		bytes[i] = (unsigned char)umodiu(rest, 256);
+		rest = shifti(rest, -8);
+	}
+	output_binary_u32(bin, len);
+	output_bytes_put(bin, bytes, len);
+	avma = ltop;
+}
+
+static void output_binary_point(output_bytes_t *bin, point_t *point) {
+	output_binary_int(bin, field_elementi(gel(point->point, 1)));
+	output_binary_int(bin, field_elementi(gel(point->point, 2)));
+	output_binary_int(bin, point->order);
+	output_binary_int(bin, point->cofactor ? point->cofactor : gen_0);
+}
+
+char *output_sbinary(curve_t *curve) {
+	pari_sp ltop = avma;
+	output_bytes_t bin = {0};
+	// the record length, filled in at the end
+	output_binary_u32(&bin, 0);
+
+	switch (cfg->field) {
+		case FIELD_PRIME: {
+			unsigned char type = 0;
+			output_bytes_put(&bin, &type, 1);
+			output_binary_int(&bin, curve->field);
+			break;
 		}
-		if (curve->meta.frobenius_trace != NULL) {
-			char *frobenius = pari_sprintf("%Pi", curve->meta.frobenius_trace);
-			json_object_dotset_string(root_object, "meta.frobenius", frobenius);
-			pari_free(frobenius);
+		case FIELD_BINARY: {
+			unsigned char type = 1;
+			output_bytes_put(&bin, &type, 1);
+			GEN field = field_params(curve->field);
+			for (long i = 1; i <= 4; ++i) {
+				output_binary_int(&bin, gel(field, i));
+			}
+			break;
 		}
-		if (curve->meta.cm_discriminant != NULL) {
-			char *cm_discriminant =
-			    pari_sprintf("%Pi", curve->meta.cm_discriminant);
-			json_object_dotset_string(root_object, "meta.cm_discriminant",
-			                          cm_discriminant);
-			pari_free(cm_discriminant);
+		default:
+			fprintf(err, "Error, field has unknown amount of elements.\n");
+			exit(1);
+	}
+	if (curve->seed) {
+		size_t len = bits_to_rawlen(curve->seed->seed);
+		unsigned char *raw = bits_to_raw(curve->seed->seed);
+		output_binary_u32(&bin, len);
+		output_bytes_put(&bin, raw, len);
+		try_free(raw);
+	} else {
+		output_binary_u32(&bin, 0);
+	}
+
+	output_binary_int(&bin, field_elementi(curve->a));
+	output_binary_int(&bin, field_elementi(curve->b));
+	output_binary_int(&bin, curve->order);
+
+	output_binary_u32(&bin, curve->ngens);
+	for (size_t i = 0; i < curve->ngens; ++i) {
+		output_binary_point(&bin, curve->generators[i]->generator);
+		output_binary_u32(&bin, curve->generators[i]->npoints);
+		for (size_t j = 0; j < curve->generators[i]->npoints; ++j) {
+			output_binary_point(&bin, curve->generators[i]->points[j]);
 		}
-		if (curve->meta.conductor != NULL) {
-			char *conductor = pari_sprintf("%Pi", curve->meta.conductor);
-			json_object_dotset_string(root_object, "meta.conductor",
-			                          conductor);
-			pari_free(conductor);
+	}
+
+	size_t len = bin.len - 4;
+	bin.data[0] = (unsigned char)(len >> 24);
+	bin.data[1] = (unsigned char)(len >> 16);
+	bin.data[2] = (unsigned char)(len >> 8);
+	bin.data[3] = (unsigned char)len;
+	avma = ltop;
+	return (char *)bin.data;
+}
+
+char *output_sbinary_separator() { return NULL; }
+
+char *output_sbinary_begin() { return output_malloc(OUTPUT_BINARY_MAGIC); }
+
+char *output_sbinary_end() { return NULL; }
+
+/**
+ * @brief A column of the CSV format.
+ */
+enum csv_column_e {
+	CSV_P,
+	CSV_M,
+	CSV_E1,
+	CSV_E2,
+	CSV_E3,
+	CSV_SEED,
+	CSV_A,
+	CSV_B,
+	CSV_ORDER,
+	CSV_SUBGROUP,
+	CSV_POINT,
+	CSV_X,
+	CSV_Y,
+	CSV_POINT_ORDER,
+	CSV_COFACTOR,
+	CSV_END
+};
+
+static const char *csv_names[] = {
+    "p",     "m",        "e1",    "e2", "e3", "seed",        "a",       "b",
+    "order", "subgroup", "point", "x",  "y",  "point_order", "cofactor"};
+
+#define OUTPUT_CSV_DEFAULT \
+	"field,seed,a,b,order,subgroup,point,x,y,point_order,cofactor"
+
+static enum csv_column_e csv_columns[CSV_END + 4];
+static size_t csv_ncolumns = 0;
+
+static bool output_csv_add(enum csv_column_e column) {
+	if (csv_ncolumns == sizeof(csv_columns) / sizeof(csv_columns[0])) {
+		return false;
+	}
+	csv_columns[csv_ncolumns++] = column;
+	return true;
+}
+
+bool output_csv_columns(const char *columns) {
+	csv_ncolumns = 0;
+	if (!columns) {
+		columns = OUTPUT_CSV_DEFAULT;
+	}
+	const char *name = columns;
+	while (*name) {
+		size_t len = strcspn(name, ",");
+		bool found = false;
+		if (len == 5 && !strncmp(name, "field", len)) {
+			// the columns of the field, as they differ for F_p and F_2^m
+			if (cfg->field == FIELD_PRIME) {
+				found = output_csv_add(CSV_P);
+			} else {
+				found = output_csv_add(CSV_M) && output_csv_add(CSV_E1) &&
+				        output_csv_add(CSV_E2) && output_csv_add(CSV_E3);
+			}
+		} else {
+			for (size_t i = 0; i < CSV_END; ++i) {
+				if (strlen(csv_names[i]) == len &&
+				    !strncmp(name, csv_names[i], len)) {
+					found = output_csv_add((enum csv_column_e)i);
+					break;
+				}
+			}
+		}
+		if (!found) {
+			fprintf(err, "Unknown or too many CSV columns at %.*s.\n",
+			        (int)len, name);
+			return false;
+		}
+		name += len;
+		if (*name == ',') name++;
+	}
+	if (!csv_ncolumns) {
+		fprintf(err, "No CSV columns given.\n");
+		return false;
+	}
+	return true;
+}
+
+static void output_csv_value(output_bytes_t *row, const char *value) {
+	output_bytes_put(row, value, strlen(value));
+}
+
+/* Field elements and the curve order are padded to hex_digits, like in JSON. */
+static void output_csv_gen(output_bytes_t *row, GEN value, bool padded) {
+	char *str = padded ? pari_sprintf("%P0#*x", cfg->hex_digits, value)
+	                   : pari_sprintf("%P#x", value);
+	output_csv_value(row, str);
+	pari_free(str);
+}
+
+static void output_csv_row(output_bytes_t *row, curve_t *curve,
+                           size_t subgroup, size_t index) {
+	subgroup_t *sub = curve->ngens ? curve->generators[subgroup] : NULL;
+	point_t *point = NULL;
+	if (sub) {
+		point = index ? sub->points[index - 1] : sub->generator;
+	}
+	GEN field = cfg->field == FIELD_BINARY ? field_params(curve->field) : NULL;
+
+	for (size_t i = 0; i < csv_ncolumns; ++i) {
+		if (i) output_csv_value(row, ",");
+		switch (csv_columns[i]) {
+			case CSV_P:
+				if (!field) output_csv_gen(row, curve->field, true);
+				break;
+			case CSV_M:
+			case CSV_E1:
+			case CSV_E2:
+			case CSV_E3:
+				if (field) {
+					output_csv_gen(row, gel(field, csv_columns[i] - CSV_M + 1),
+					               false);
+				}
+				break;
+			case CSV_SEED:
+				if (curve->seed) {
+					char *hex = bits_to_hex(curve->seed->seed);
+					output_csv_value(row, "0x");
+					output_csv_value(row, hex);
+					try_free(hex);
+				}
+				break;
+			case CSV_A:
+				output_csv_gen(row, field_elementi(curve->a), true);
+				break;
+			case CSV_B:
+				output_csv_gen(row, field_elementi(curve->b), true);
+				break;
+			case CSV_ORDER:
+				output_csv_gen(row, curve->order, true);
+				break;
+			case CSV_SUBGROUP:
+				if (sub) {
+					char num[32];
+					sprintf(num, "%zu", subgroup);
+					output_csv_value(row, num);
+				}
+				break;
+			case CSV_POINT:
+				if (sub) {
+					char num[32];
+					sprintf(num, "%zu", index);
+					output_csv_value(row, num);
+				}
+				break;
+			case CSV_X:
+				if (point) {
+					output_csv_gen(row, field_elementi(gel(point->point, 1)),
+					               true);
+				}
+				break;
+			case CSV_Y:
+				if (point) {
+					output_csv_gen(row, field_elementi(gel(point->point, 2)),
+					               true);
+				}
+				break;
+			case CSV_POINT_ORDER:
+				if (point) output_csv_gen(row, point->order, false);
+				break;
+			case CSV_COFACTOR:
+				if (sub && sub->generator->cofactor) {
+					output_csv_gen(row, sub->generator->cofactor, false);
+				}
+				break;
+			default:
+				break;
 		}
 	}
+	output_csv_value(row, "\n");
+}
 
+char *output_scsv(curve_t *curve) {
+	pari_sp ltop = avma;
+	output_bytes_t row = {0};
+	if (!curve->ngens) {
+		output_csv_row(&row, curve, 0, 0);
+	}
+	for (size_t i = 0; i < curve->ngens; ++i) {
+		// the generator, then the points of its subgroup
+		for (size_t j = 0; j <= curve->generators[i]->npoints; ++j) {
+			output_csv_row(&row, curve, i, j);
+		}
+	}
+	output_bytes_put(&row, "", 1);
 	avma = ltop;
-	return root_value;
+	return (char *)row.data;
 }
 
-char *output_sjson(curve_t *curve) {
-	JSON_Value *root_value = output_jjson(curve);
-	char *result = json_serialize_to_string_pretty(root_value);
-	json_value_free(root_value);
+char *output_scsv_separator() { return NULL; }
 
-	return result;
+char *output_scsv_begin() {
+	output_bytes_t header = {0};
+	for (size_t i = 0; i < csv_ncolumns; ++i) {
+		if (i) output_csv_value(&header, ",");
+		output_csv_value(&header, csv_names[csv_columns[i]]);
+	}
+	output_csv_value(&header, "\n");
+	output_bytes_put(&header, "", 1);
+	return (char *)header.data;
 }
 
+char *output_scsv_end() { return NULL; }
+
 char *output_sjson_separator() { return output_malloc(",\n"); }
 
 char *output_sjson_begin() { return output_malloc("[\n"); }
 
 char *output_sjson_end() { return output_malloc("]\n"); }
 
+static void *output_write(void *arg) {
+	unsigned long records = 0;
+	output_item_t *item;
+	while ((item = queue_pop(output_queue))) {
+		if (item->data) {
+			fwrite(item->data, 1, item->len, out);
+			try_free(item->data);
+			if (item->record) {
+				records++;
+				if (cfg->flush == FLUSH_RECORD ||
+				    (cfg->flush == FLUSH_EVERY &&
+				     records % cfg->flush_every == 0)) {
+					fflush(out);
+				}
+			}
+		} else {
+			fflush(out);
+			pthread_mutex_lock(&output_flush_mutex);
+			output_flush_done++;
+			pthread_cond_broadcast(&output_flush_cond);
+			pthread_mutex_unlock(&output_flush_mutex);
+		}
+		try_free(item);
+	}
+	fflush(out);
+	return NULL;
+}
+
+static void output_push(char *data, bool record) {
+	if (!data) return;
+	output_item_t *item = try_calloc(sizeof(output_item_t));
+	item->data = data;
+	item->len = output_length(data, record);
+	item->record = record;
+	queue_push(output_queue, item);
+}
+
+void output_flush(void) {
+	pthread_mutex_lock(&output_flush_mutex);
+	unsigned long request = ++output_flush_requested;
+	pthread_mutex_unlock(&output_flush_mutex);
+
+	queue_push(output_queue, try_calloc(sizeof(output_item_t)));
+
+	pthread_mutex_lock(&output_flush_mutex);
+	while (output_flush_done < request) {
+		pthread_cond_wait(&output_flush_cond, &output_flush_mutex);
+	}
+	pthread_mutex_unlock(&output_flush_mutex);
+}
+
 void output_f(FILE *out, curve_t *curve) {
 	char *s = output_s(curve);
 	if (s) {
-		fprintf(out, "%s", s);
+		fwrite(s, 1, output_length(s, true), out);
 		try_free(s);
 	}
 }
 
-void output_o(curve_t *curve) { output_f(out, curve); }
+void output_o(curve_t *curve) { output_push(output_s(curve), true); }
+
+void output_f_raw(FILE *out, const char *s) {
+	fwrite(s, 1, output_length(s, true), out);
+}
+
+void output_o_raw(const char *s) {
+	output_push(try_memdup(s, output_length(s, true)), true);
+}
 
 void output_f_separator(FILE *out) {
 	char *s = output_s_separator();
@@ -199,7 +629,7 @@ void output_f_separator(FILE *out) {
 	}
 }
 
-void output_o_separator() { output_f_separator(out); }
+void output_o_separator() { output_push(output_s_separator(), false); }
 
 void output_f_begin(FILE *out) {
 	char *s = output_s_begin();
@@ -209,7 +639,14 @@ void output_f_begin(FILE *out) {
 	}
 }
 
-void output_o_begin() { output_f_begin(out); }
+void output_o_begin() {
+	// in batch mode, JSON outputs an array per record, the CSV header row and
+	// the binary header are only output once
+	static bool begun = false;
+	if (cfg->batch && begun && cfg->format != FORMAT_JSON) return;
+	begun = true;
+	output_push(output_s_begin(), false);
+}
 
 void output_f_end(FILE *out) {
 	char *s = output_s_end();
@@ -219,13 +656,22 @@ void output_f_end(FILE *out) {
 	}
 }
 
-void output_o_end() { output_f_end(out); }
+void output_o_end() { output_push(output_s_end(), false); }
 
 bool output_init() {
 	json_set_allocation_functions(try_malloc, try_free);
 
 	if (cfg->output) {
-		out = fopen(cfg->output, cfg->append ? "a" : "w");
+		if (cfg->resume) {
+			// the checkpoint says where to continue the output from
+			out = fopen(cfg->output, "r+");
+			if (!out) {
+				perror("Failed to open output file to resume.");
+				return false;
+			}
+		} else {
+			out = fopen(cfg->output, cfg->append ? "a" : "w");
+		}
 		if (!out) {
 			// fallback to stdout and output err
 			out = stdout;
@@ -234,7 +680,10 @@ bool output_init() {
 	} else {
 		out = stdout;
 	}
-	setvbuf(out, NULL, _IONBF, 0);
+	// only the writer thread writes to out, in large chunks
+	setvbuf(out, output_buffer, _IOFBF, OUTPUT_BUFFER_SIZE);
+	output_queue = queue_new(OUTPUT_QUEUE_SIZE);
+	pthread_create(&output_writer, NULL, &output_write, NULL);
 
 	err = stderr;
 	setvbuf(err, NULL, _IONBF, 0);
@@ -258,6 +707,30 @@ bool output_init() {
 			output_s_end = &output_sjson_end;
 			break;
 		}
+		case FORMAT_NDJSON: {
+			output_s = &output_sndjson;
+			output_s_separator = &output_sndjson_separator;
+			output_s_begin = &output_sndjson_begin;
+			output_s_end = &output_sndjson_end;
+			break;
+		}
+		case FORMAT_CSV: {
+			if (!output_csv_columns(cfg->columns)) {
+				return false;
+			}
+			output_s = &output_scsv;
+			output_s_separator = &output_scsv_separator;
+			output_s_begin = &output_scsv_begin;
+			output_s_end = &output_scsv_end;
+			break;
+		}
+		case FORMAT_BINARY: {
+			output_s = &output_sbinary;
+			output_s_separator = &output_sbinary_separator;
+			output_s_begin = &output_sbinary_begin;
+			output_s_end = &output_sbinary_end;
+			break;
+		}
 	}
 	return true;
 }
@@ -267,8 +740,15 @@ static bool output_is_std(FILE *stream) {
 }
 
 void output_quit(void) {
+	if (output_queue) {
+		queue_close(output_queue);
+		pthread_join(output_writer, NULL);
+		queue_free(&output_queue);
+	}
 	if (!output_is_std(out)) {
 		fclose(out);
+	} else {
+		fflush(out);
 	}
 	if (!output_is_std(err)) {
 		fclose(err);
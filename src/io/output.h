@@ -105,6 +105,100 @@ char *output_sjson_begin();
  */
 char *output_sjson_end();
 
+/**
+ * @brief Output curve to a malloc'ed string as a single line of compact JSON.
+ * @param curve
+ * @return
+ */
+char *output_sndjson(curve_t *curve);
+
+/**
+ * @brief NDJSON has no separator.
+ * @return NULL
+ */
+char *output_sndjson_separator();
+
+/**
+ * @brief NDJSON has no header.
+ * @return NULL
+ */
+char *output_sndjson_begin();
+
+/**
+ * @brief NDJSON has no footer.
+ * @return NULL
+ */
+char *output_sndjson_end();
+
+/**
+ * @brief The header of the binary format.
+ */
+#define OUTPUT_BINARY_MAGIC "ECGEN\x01"
+
+/**
+ * @brief Output curve to a malloc'ed binary record, see docs/output.md.
+ *
+ * The record starts with its length, as a big-endian 32-bit integer, which
+ * does not include the length itself.
+ *
+ * @param curve
+ * @return
+ */
+char *output_sbinary(curve_t *curve);
+
+/**
+ * @brief The binary format has no separator.
+ * @return NULL
+ */
+char *output_sbinary_separator();
+
+/**
+ * @brief Output the binary format header(OUTPUT_BINARY_MAGIC) to a
+ * malloc'ed string.
+ * @return
+ */
+char *output_sbinary_begin();
+
+/**
+ * @brief The binary format has no footer.
+ * @return NULL
+ */
+char *output_sbinary_end();
+
+/**
+ * @brief Select the columns of the CSV format.
+ * @param columns comma separated column names, "field" selects all the columns
+ * of the field, NULL selects the default columns
+ * @return whether the columns are valid
+ */
+bool output_csv_columns(const char *columns);
+
+/**
+ * @brief Output curve to a malloc'ed string as CSV rows, one for every
+ * subgroup generator and point.
+ * @param curve
+ * @return
+ */
+char *output_scsv(curve_t *curve);
+
+/**
+ * @brief CSV has no separator.
+ * @return NULL
+ */
+char *output_scsv_separator();
+
+/**
+ * @brief Output the CSV header row to a malloc'ed string.
+ * @return
+ */
+char *output_scsv_begin();
+
+/**
+ * @brief CSV has no footer.
+ * @return NULL
+ */
+char *output_scsv_end();
+
 /**
  * @brief Output curve to a malloc'ed string in configured format.
  * @param curve
@@ -125,6 +219,21 @@ void output_f(FILE *out, curve_t *curve);
  */
 void output_o(curve_t *curve);
 
+/**
+ * @brief Output an already serialized curve(from output_s) to a FILE *out.
+ * Binary records are written whole, according to their length.
+ * @param out
+ * @param s
+ */
+void output_f_raw(FILE *out, const char *s);
+
+/**
+ * @brief Output an already serialized curve(from output_s) to configured
+ * output.
+ * @param s
+ */
+void output_o_raw(const char *s);
+
 /**
  * @brief Output separator to a malloc'ed string in configured format.
  * @return
@@ -176,6 +285,15 @@ void output_f_end(FILE *out);
  */
 void output_o_end();
 
+/**
+ * @brief Wait until everything output to the configured output so far is
+ * written and flushed.
+ *
+ * The output_o_* functions only queue their output for a writer thread,
+ * which writes it out according to cfg->flush.
+ */
+void output_flush(void);
+
 /**
  * @brief Configured output FILE*.
  */
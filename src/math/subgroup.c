@@ -3,74 +3,171 @@
  * Copyright (C) 2017-2018 J08nY
  */
 #include "subgroup.h"
+#include "util/memory.h"
 
 /**
- * @brief All prime divisors of a given integer with multiplicity.
- *
- * subgroups_divisors(27) = [3, 3, 3]
- * @param order
- * @return a t_VEC of prime divisors.
+ * @brief The factorization of order, unless it is already given as one.
+ * @param order a t_INT or a t_MAT
+ * @return a t_MAT
  */
-static GEN subgroups_divisors(GEN order) {
-	GEN factors = Z_factor(order);
-	GEN primes = gel(factors, 1);
-	GEN multiples = gel(factors, 2);
-	long uniqs = glength(primes);
+static GEN subgroups_factored(GEN order) {
+	if (typ(order) == t_MAT) {
+		return order;
+	}
+	return Z_factor(order);
+}
 
-	long size = 0;
-	for (long i = 1; i <= uniqs; ++i) {
-		size += itos(gel(multiples, i));
+/**
+ * @brief Whether order is a prime, looking at its factorization if given.
+ * @param order a t_INT or a t_MAT
+ * @return
+ */
+static bool subgroups_isprime(GEN order) {
+	if (typ(order) == t_MAT) {
+		return glength(gel(order, 1)) == 1 && equali1(gcoeff(order, 1, 2));
 	}
-	GEN result = gtovec0(gen_0, size);
+	return isprime(order);
+}
 
-	long count = 0;
-	for (long i = 1; i <= uniqs; ++i) {
-		long multiple = itos(gel(multiples, i));
-		for (long j = 1; j <= multiple; ++j) {
-			gel(result, ++count) = gel(primes, i);
+/**
+ * @brief A divisor in the lattice enumeration, with the index and exponent of
+ * its largest prime and the number of its prime factors with multiplicity.
+ */
+typedef struct {
+	GEN value;
+	long last;
+	long exp;
+	long omega;
+} divisor_t;
+
+/**
+ * @brief A binary min-heap of divisors, by value.
+ */
+typedef struct {
+	divisor_t *items;
+	size_t len;
+	size_t alloc;
+} divisor_heap_t;
+
+static void subgroups_push(divisor_heap_t *heap, divisor_t item) {
+	if (heap->len == heap->alloc) {
+		heap->alloc *= 2;
+		heap->items =
+		    try_realloc(heap->items, heap->alloc * sizeof(divisor_t));
+	}
+	size_t i = heap->len++;
+	while (i > 0) {
+		size_t parent = (i - 1) / 2;
+		if (cmpii(heap->items[parent].value, item.value) <= 0) break;
+		heap->items[i] = heap->items[parent];
+		i = parent;
+	}
+	heap->items[i] = item;
+}
+
+static divisor_t subgroups_pop(divisor_heap_t *heap) {
+	divisor_t top = heap->items[0];
+	divisor_t item = heap->items[--heap->len];
+	size_t i = 0;
+	while (2 * i + 1 < heap->len) {
+		size_t child = 2 * i + 1;
+		if (child + 1 < heap->len &&
+		    cmpii(heap->items[child + 1].value, heap->items[child].value) <
+		        0) {
+			child++;
 		}
+		if (cmpii(item.value, heap->items[child].value) <= 0) break;
+		heap->items[i] = heap->items[child];
+		i = child;
 	}
-	return result;
+	heap->items[i] = item;
+	return top;
 }
 
 /**
- * @brief All factors consisting of at least <code>min_bits</code> prime
- * <code>factors</code>.
+ * @brief The distinct divisors with more than <code>min_primes</code> prime
+ * factors (with multiplicity), in increasing order, at most <code>max</code>
+ * of them.
+ *
+ * Walks the divisor lattice from the exponent vector of the factorization,
+ * a divisor is extended only by its largest prime or larger ones, so each is
+ * reached exactly once, and popped from a heap in increasing order. Only
+ * the divisors output and their direct successors are ever computed.
  *
- * @param factors
- * @param min_bits
- * @return a t_VEC of factors
+ * @param factors a t_MAT, the factorization
+ * @param min_primes
+ * @param max the maximum number of divisors, 0 for all
+ * @return a t_VEC of divisors
  */
-static GEN subgroups_2n_factors(GEN factors, size_t min_bits) {
+static GEN subgroups_lattice(GEN factors, long min_primes, size_t max) {
 	pari_sp ltop = avma;
-	long nprimes = glength(factors);
-	if (nprimes == min_bits) return NULL;
-	GEN amount = int2n(nprimes);
-	GEN groups = gtovec0(gen_0, itos(amount) - (min_bits * nprimes) - 1);
+	GEN primes = gel(factors, 1);
+	GEN exps = gel(factors, 2);
+	long nprimes = glength(primes);
 
-	size_t i = 0;
-	for (size_t count = 1; count < (size_t)(1) << nprimes; ++count) {
-		pari_sp btop = avma;
-		GEN result = gen_1;
-		size_t bits = 0;
-		for (long bit = 0; bit < nprimes; ++bit) {
-			size_t mask = (size_t)(1) << bit;
-			if (count & mask) {
-				result = mulii(result, gel(factors, bit + 1));
-				bits++;
-			}
+	GEN total = gen_1;
+	for (long i = 1; i <= nprimes; ++i) {
+		total = mulis(total, itos(gel(exps, i)) + 1);
+	}
+	long size = 0;
+	if (max && cmpiu(total, max) > 0) {
+		size = (long)max;
+	} else {
+		size = itos(total);
+	}
+	GEN result = cgetg(size + 1, t_VEC);
+
+	divisor_heap_t heap = {.len = 0, .alloc = (size_t)nprimes + 1};
+	heap.items = try_calloc(heap.alloc * sizeof(divisor_t));
+	subgroups_push(&heap, (divisor_t){gen_1, 0, 0, 0});
+
+	long count = 0;
+	while (heap.len && count < size) {
+		divisor_t d = subgroups_pop(&heap);
+		if (d.omega > min_primes) {
+			gel(result, ++count) = d.value;
+		}
+		if (d.last && d.exp < itos(gel(exps, d.last))) {
+			GEN value = mulii(d.value, gel(primes, d.last));
+			subgroups_push(&heap, (divisor_t){value, d.last, d.exp + 1,
+			                                  d.omega + 1});
 		}
-		if (bits > min_bits) {
-			gel(groups, ++i) = result;
-		} else {
-			avma = btop;
+		for (long j = d.last + 1; j <= nprimes; ++j) {
+			GEN value = mulii(d.value, gel(primes, j));
+			subgroups_push(&heap, (divisor_t){value, j, 1, d.omega + 1});
 		}
 	}
-	GEN ret = gtoset(groups);
-	return gerepilecopy(ltop, ret);
+	try_free(heap.items);
+
+	setlg(result, count + 1);
+	return gerepilecopy(ltop, result);
+}
+
+GEN subgroups_factors(GEN factors, GEN n) {
+	pari_sp ltop = avma;
+	GEN primes = gel(factors, 1);
+	long len = glength(primes);
+	GEN ps = cgetg(len + 1, t_COL);
+	GEN es = cgetg(len + 1, t_COL);
+
+	long count = 0;
+	for (long i = 1; i <= len; ++i) {
+		long e = Z_pval(n, gel(primes, i));
+		if (e) {
+			++count;
+			gel(ps, count) = gel(primes, i);
+			gel(es, count) = stoi(e);
+		}
+	}
+	setlg(ps, count + 1);
+	setlg(es, count + 1);
+	return gerepilecopy(ltop, mkmat2(ps, es));
 }
 
 GEN subgroups_prime(GEN order) {
+	if (typ(order) == t_MAT) {
+		return gtovec(gel(order, 1));
+	}
 	if (isprime(order)) {
 		return gtovec(order);
 	}
@@ -78,66 +175,16 @@ GEN subgroups_prime(GEN order) {
 	return gtovec(gel(factors, 1));
 }
 
-GEN subgroups_nonprime(GEN order) {
-	if (isprime(order)) {
+GEN subgroups_nonprime(GEN order, size_t max) {
+	if (subgroups_isprime(order)) {
 		return NULL;
 	}
-	GEN factors = subgroups_divisors(order);
-	return subgroups_2n_factors(factors, 1);
+	return subgroups_lattice(subgroups_factored(order), 1, max);
 }
 
-GEN subgroups_all(GEN order) {
-	if (isprime(order)) {
-		return gtovec(order);
+GEN subgroups_all(GEN order, size_t max) {
+	if (subgroups_isprime(order)) {
+		return subgroups_prime(order);
 	}
-	GEN factors = subgroups_divisors(order);
-	return subgroups_2n_factors(factors, 0);
+	return subgroups_lattice(subgroups_factored(order), 0, max);
 }
-
-/**
- * @brief
- * @param curve
- * @param min_bits
- * @return
- */
-/*
-static GEN subgroups_2n_gens(const curve_t *curve, size_t min_bits) {
-    GEN one_factors = subgroups_divisors(curve->generators[0]->order);
-    GEN one = subgroups_2n_factors(one_factors, min_bits);
-    GEN other_factors = subgroups_divisors(curve->generators[1]->order);
-    GEN other = subgroups_2n_factors(other_factors, min_bits);
-    if (!one) {
-        return other;
-    }
-    if (!other) {
-        return one;
-    }
-    GEN result = gtovec0(gen_0, glength(one) + glength(other));
-    for (long i = 1; i <= glength(result); ++i) {
-        if (i <= glength(one)) {
-            gel(result, i) = gel(one, i);
-        } else {
-            gel(result, i) = gel(other, i - glength(one));
-        }
-    }
-    return result;
-}
- */
-
-/**
- * @brief
- * @param curve
- * @param min_bits
- * @return
- */
-/*
-static GEN subgroups_2n(const curve_t *curve, size_t min_bits) {
-   if (curve->ngens == 1) {
-       GEN factors = subgroups_divisors(curve->order);
-       return subgroups_2n_factors(factors, min_bits);
-   }
-
-   return subgroups_2n_gens(curve, min_bits);
-}
-
-*/
\ No newline at end of file
@@ -11,27 +11,41 @@
 #include <pari/pari.h>
 #include "misc/types.h"
 
+/**
+ * @brief The factorization of <code>n</code>, from the factorization of its
+ * multiple, without factoring again.
+ *
+ * subgroups_factors([2, 2; 3, 1], 6) = [2, 1; 3, 1]
+ * @param factors a t_MAT, factorization of a multiple of <code>n</code>
+ * @param n
+ * @return a t_MAT, the factorization of <code>n</code>
+ */
+GEN subgroups_factors(GEN factors, GEN n);
+
 /**
  * @brief All prime factors of a given integer, without multipliticity.
  *
- * subgroups_factors(27) = [3]
- * @param order
+ * subgroups_prime(27) = [3]
+ * @param order a t_INT, or its factorization as a t_MAT
  * @return a t_VEC of prime factors.
  */
 GEN subgroups_prime(GEN order);
 
 /**
- * @brief All nonprime subgroup orders of a given integer.
- * @param order
+ * @brief All nonprime subgroup orders of a given integer, in increasing
+ * order.
+ * @param order a t_INT, or its factorization as a t_MAT
+ * @param max the maximum number of orders, the smallest ones, 0 for all
  * @return a t_VEC of nonprime factors.
  */
-GEN subgroups_nonprime(GEN order);
+GEN subgroups_nonprime(GEN order, size_t max);
 
 /**
- * @brief All all subgroup orders of a given integer.
- * @param order
+ * @brief All all subgroup orders of a given integer, in increasing order.
+ * @param order a t_INT, or its factorization as a t_MAT
+ * @param max the maximum number of orders, the smallest ones, 0 for all
  * @return a t_VEC of all factors.
  */
-GEN subgroups_all(GEN order);
+GEN subgroups_all(GEN order, size_t max);
 
 #endif  // ECGEN_MATH_SUBGROUPS_H
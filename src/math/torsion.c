@@ -0,0 +1,50 @@
+/*
+ * ecgen, tool for generating Elliptic curve domain parameters
+ * Copyright (C) 2017-2018 J08nY
+ */
+#include "torsion.h"
+
+static bool torsion_divides_either(const curve_t *curve, pari_ulong l,
+                                   bool twist) {
+	pari_sp ltop = avma;
+	GEN p = curve->field;
+	/* 4x^3 + b2x^2 + 2b4x + b6, i.e. (2y + a1x + a3)^2 on the curve */
+	GEN psi2 = RgX_to_FpX(elldivpol(curve->curve, 2, 0), p);
+
+	bool result = false;
+	if (l == 2) {
+		result = FpX_nbroots(psi2, p) > 0;
+	} else {
+		GEN psi = RgX_to_FpX(elldivpol(curve->curve, (long)l, 0), p);
+		GEN roots = FpX_roots(psi, p);
+		for (long i = 1; i < lg(roots); ++i) {
+			GEN y2 = FpX_eval(psi2, gel(roots, i), p);
+			if (twist || kronecker(y2, p) >= 0) {
+				result = true;
+				break;
+			}
+		}
+	}
+	avma = ltop;
+	return result;
+}
+
+bool torsion_divides(const curve_t *curve, pari_ulong l) {
+	return torsion_divides_either(curve, l, false);
+}
+
+bool torsion_divides_any(const curve_t *curve, const pari_ulong *primes,
+                         size_t nprimes, pari_ulong bound, bool twist) {
+	for (size_t i = 0; i < nprimes; ++i) {
+		// no cheap answer for these, so they might divide the order
+		if (primes[i] > bound || cmpiu(curve->field, primes[i]) <= 0) {
+			return true;
+		}
+	}
+	for (size_t i = 0; i < nprimes; ++i) {
+		if (torsion_divides_either(curve, primes[i], twist)) {
+			return true;
+		}
+	}
+	return false;
+}
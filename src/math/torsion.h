@@ -0,0 +1,49 @@
+/*
+ * ecgen, tool for generating Elliptic curve domain parameters
+ * Copyright (C) 2017-2018 J08nY
+ */
+/**
+ * @file torsion.h
+ */
+#ifndef ECGEN_MATH_TORSION_H
+#define ECGEN_MATH_TORSION_H
+
+#include <stdbool.h>
+#include "misc/types.h"
+
+/**
+ * @brief Whether the prime l divides the order of a curve over a prime field.
+ *
+ * Does not compute the order, instead looks for an x-coordinate in F_p of an
+ * l-torsion point among the roots of the l-division polynomial and checks
+ * that the point is defined over F_p and not only over its quadratic
+ * extension (on the quadratic twist).
+ *
+ * @param curve a curve over a prime field, with curve->curve set
+ * @param l a prime
+ * @return whether the curve has a point of order l
+ */
+bool torsion_divides(const curve_t *curve, pari_ulong l);
+
+/**
+ * @brief Whether some of the primes might divide the order of a curve over a
+ * prime field.
+ *
+ * Primes up to <code>bound</code> are tested with torsion_divides, which
+ * costs more with every prime, as the degree of the l-division polynomial is
+ * (l^2 - 1) / 2. If any of the primes is larger than the bound, the answer is
+ * true without testing. With <code>twist</code>, an x-coordinate of an
+ * l-torsion point in F_p is enough, as the point is then on the curve or on
+ * its quadratic twist.
+ *
+ * @param curve a curve over a prime field, with curve->curve set
+ * @param primes
+ * @param nprimes
+ * @param bound the largest prime to test
+ * @param twist whether to also look at the order of the quadratic twist
+ * @return false if none of the primes divides the order (or the twist order)
+ */
+bool torsion_divides_any(const curve_t *curve, const pari_ulong *primes,
+                         size_t nprimes, pari_ulong bound, bool twist);
+
+#endif  // ECGEN_MATH_TORSION_H
@@ -3,30 +3,70 @@
  * Copyright (C) 2017-2018 J08nY
  */
 #include "twists.h"
+#include "gen/order.h"
 #include "gen/seed.h"
 #include "obj/subgroup.h"
 
+GEN twist_order(const curve_t *of) {
+	GEN q;
+	if (typ(of->field) == t_INT) {
+		q = addis(mulis(of->field, 2), 2);
+	} else {
+		q = addis(mulis(int2n(degree(FF_mod(of->field))), 2), 2);
+	}
+	return subii(q, of->order);
+}
+
 void twist_rand_to(curve_t *to, const curve_t *of) {
+	// the twist has a different order, when twisting in place
+	order_factors_free(to);
 	to->field = gcopy(of->field);
 	GEN v = elltwist(of->curve, NULL);
 	to->curve = ellinit(v, to->field, -1);
 	if (typ(of->field) == t_INT) {
 		to->a = ell_get_a4(to->curve);
 		to->b = ell_get_a6(to->curve);
-		if (of->order != NULL) {
-			GEN q = addis(mulis(of->field, 2), 2);
-			to->order = subii(q, of->order);
-			obj_insert_shallow(to->curve, 1, to->order);
-		}
 	} else if (typ(of->field) == t_FFELT) {
 		to->a = ell_get_a2(to->curve);
 		to->b = ell_get_a6(to->curve);
-		if (of->order != NULL) {
-			GEN q = addis(mulis(int2n(degree(FF_mod(of->field))), 2), 2);
-			to->order = subii(q, of->order);
-			obj_insert_shallow(to->curve, 1, to->order);
+	}
+	if (of->order != NULL) {
+		to->order = twist_order(of);
+		obj_insert_shallow(to->curve, 1, to->order);
+	}
+}
+
+bool twist_keeps_a(const curve_t *of) {
+	/* twisting by d gives (a * d^2, b * d^3), so d = -1 keeps a if it is a
+	 * non-residue (p = 3 mod 4), any non-residue d keeps a = 0 */
+	return typ(of->field) == t_INT &&
+	       (mod4(of->field) == 3 || gequal0(of->a));
+}
+
+bool twist_same_a_to(curve_t *to, const curve_t *of) {
+	if (!twist_keeps_a(of)) {
+		return false;
+	}
+	GEN d;
+	if (mod4(of->field) == 3) {
+		d = gen_m1;
+	} else {
+		long n = 2;
+		while (krosi(n, of->field) != -1) {
+			n++;
 		}
+		d = stoi(n);
+	}
+
+	to->field = gcopy(of->field);
+	to->a = gcopy(of->a);
+	to->b = gmul(of->b, powis(d, 3));
+	to->curve = ellinit(mkvec2(to->a, to->b), to->field, -1);
+	if (of->order != NULL) {
+		to->order = twist_order(of);
+		obj_insert_shallow(to->curve, 1, to->order);
 	}
+	return true;
 }
 
 void twist_rand(curve_t *what) {
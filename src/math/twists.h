@@ -7,6 +7,13 @@
 
 #include "misc/types.h"
 
+/**
+ * @brief The order of the quadratic twist of a curve, 2q + 2 - #E.
+ * @param of The curve, with the order set.
+ * @return the order of its twist
+ */
+GEN twist_order(const curve_t *of);
+
 /**
  * @brief Twists the <code>of</code> curve randomly.
  * @param to The result of the twist.
@@ -14,6 +21,25 @@
  */
 void twist_rand_to(curve_t *to, const curve_t *of);
 
+/**
+ * @brief Whether the <code>of</code> curve has a quadratic twist with the same
+ * a coefficient, see twist_same_a_to.
+ * @param of The curve.
+ * @return whether the twist exists
+ */
+bool twist_keeps_a(const curve_t *of);
+
+/**
+ * @brief Twists the <code>of</code> curve over a prime field, keeping its a
+ * coefficient.
+ *
+ * Such a twist exists for p = 3 mod 4, where it is (a, -b), or for a = 0.
+ * @param to The result of the twist.
+ * @param of The curve to be twisted.
+ * @return whether the twist exists
+ */
+bool twist_same_a_to(curve_t *to, const curve_t *of);
+
 /**
  * @brief Twists the <code>what</code> curve randomly, inplae.
  * @param what The curve to be twisted, also the result.
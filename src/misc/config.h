@@ -12,7 +12,30 @@
 #include <stddef.h>
 
 enum field_e { FIELD_PRIME = 1 << 0, FIELD_BINARY = 1 << 1 };
-enum format_e { FORMAT_JSON };
+enum format_e {
+	FORMAT_JSON = 0,
+	FORMAT_NDJSON,
+	FORMAT_BINARY,
+	FORMAT_CSV
+};
+/**
+ * @brief The states of the generation, also used to configure them.
+ */
+typedef enum {
+	OFFSET_SEED = 0,
+	OFFSET_FIELD,
+	OFFSET_A,
+	OFFSET_B,
+	OFFSET_CURVE,
+	OFFSET_ORDER,
+	OFFSET_GENERATORS,
+	OFFSET_POINTS,
+	OFFSET_METADATA,
+	OFFSET_END
+} offset_e;
+
+enum twists_e { TWISTS_NONE = 0, TWISTS_SAME_A, TWISTS_ANY };
+enum flush_e { FLUSH_RECORD = 0, FLUSH_EVERY, FLUSH_EXIT };
 enum points_e {
 	POINTS_PRIME = 0,
 	POINTS_NONPRIME,
@@ -86,9 +109,19 @@ typedef struct {
 	/** @brief Whether the curves should have a bound on the cofactor value. */
 	bool cofactor;
 	long cofactor_value;
+	/** @brief Whether to reject curves with a small prime, up to a bound,
+	 * dividing the order before computing it. */
+	bool prefilter;
+	unsigned long prefilter_bound;
 	/** @brief A range of prime orders that should be generated in invalid
 	 * generation. */
 	char *invalid_primes;
+	/** @brief Whether to also harvest the quadratic twists of the invalid
+	 * curves, only those keeping a or any. */
+	enum twists_e invalid_twists;
+	/** @brief Whether to plan which invalid curves get their points
+	 * generated, rather than taking every curve that covers a prime. */
+	bool invalid_plan;
 	/** @brief What seed algorithm, if any, to use to generate the curves. */
 	seed_e seed_algo;
 	/** @brief What seed to use, if any, to generate the curves. */
@@ -103,27 +136,50 @@ typedef struct {
 	/** @brief Compute curve metadata. */
 	bool metadata;
 
+	/** @brief The master seed of the random streams, as hex, if any. */
+	char *rng_seed;
+
 	/** @brief The datadir to use, if any. */
 	char *datadir;
 	/** @brief How much memory to allocate for the PARI stack. */
 	unsigned long memory;
-	/** @brief How many threads to use, only useful for invalid generation(atm).
-	 */
+	/** @brief Whether to collect and output per state statistics. */
+	bool stats;
+	/** @brief Where to output the statistics, if not to verbose output. */
+	char *stats_file;
+	/** @brief How many threads to use. */
 	unsigned long threads;
+	/** @brief Whether curves generated by multiple threads should be output
+	 * in the order they were started in, rather than as they finish. */
+	bool ordered;
 	/** @brief How much memory to allocate for the PARI stack, per thread. */
 	unsigned long thread_memory;
-	/** @brief How long of a timeout interval, if any, to give to parameter
-	 * generation. */
-	unsigned long timeout;
+	/** @brief How long of a timeout interval, if any, to give to the
+	 * generation of a parameter, per state. */
+	unsigned long timeout[OFFSET_END];
+	/** @brief How long the whole run can take, if limited. */
+	unsigned long deadline;
 
 	/** @brief What output format to use. */
 	enum format_e format;
+	/** @brief What columns to output in the CSV format, comma separated. */
+	char *columns;
 	/** @brief What, if any, output file to write to. */
 	char *output;
 	/** @brief What, if any, input file to read from. */
 	char *input;
+	/** @brief Whether to process every record(line) of the input file. */
+	bool batch;
 	/** @brief Whether to append or truncate the output file on output. */
 	bool append;
+	/** @brief When to flush the output, after every record, every
+	 * flush_every records or on exit. */
+	enum flush_e flush;
+	unsigned long flush_every;
+	/** @brief Where to record progress of the run, if anywhere. */
+	char *checkpoint;
+	/** @brief Whether to resume the run from the checkpoint. */
+	bool resume;
 
 	/** @brief What verbosity level to run on. */
 	long verbose;
@@ -59,11 +59,13 @@ typedef struct {
  * @param point a t_VEC with t_INTMOD or t_FFELT components [x,y]
  * @param order a t_INT
  * @param cofactor a t_INT
+ * @param factors a t_MAT, factorization of the order, once computed
  */
 typedef struct {
 	GEN point;
 	GEN order;
 	GEN cofactor;
+	GEN factors;
 } point_t;
 
 /**
@@ -98,6 +100,7 @@ typedef struct {
  * @param b a t_INTMOD or t_FFELT b parameter
  * @param curve a t_ELL, curve object
  * @param order a t_INT, curve order
+ * @param factors a t_MAT, factorization of the curve order, once computed
  * @param generators generators saved
  * @param meta
  * @param ngens number of generators saved in the curve type
@@ -109,27 +112,12 @@ typedef struct {
 	GEN b;
 	GEN curve;
 	GEN order;
+	GEN factors;
 	subgroup_t **generators;
 	size_t ngens;
 	metadata_t meta;
 } curve_t;
 
-/**
- * @brief
- */
-typedef enum {
-	OFFSET_SEED = 0,
-	OFFSET_FIELD,
-	OFFSET_A,
-	OFFSET_B,
-	OFFSET_CURVE,
-	OFFSET_ORDER,
-	OFFSET_GENERATORS,
-	OFFSET_POINTS,
-	OFFSET_METADATA,
-	OFFSET_END
-} offset_e;
-
 extern const char *offset_s[OFFSET_END];
 
 /**
@@ -12,6 +12,7 @@ curve_t *curve_copy(const curve_t *src, curve_t *dest) {
 	if (src->b) dest->b = gcopy(src->b);
 	if (src->curve) dest->curve = gcopy(src->curve);
 	if (src->order) dest->order = gcopy(src->order);
+	if (src->factors) dest->factors = gclone(src->factors);
 	if (src->generators) {
 		dest->generators = subgroups_new_copy(src->generators, src->ngens);
 		dest->ngens = src->ngens;
@@ -26,6 +27,7 @@ curve_t *curve_clone(const curve_t *src, curve_t *dest) {
 	if (src->b) dest->b = gclone(src->b);
 	if (src->curve) dest->curve = gclone(src->curve);
 	if (src->order) dest->order = gclone(src->order);
+	if (src->factors) dest->factors = gclone(src->factors);
 	if (src->generators) {
 		dest->generators = subgroups_new_clone(src->generators, src->ngens);
 		dest->ngens = src->ngens;
@@ -58,6 +60,9 @@ void curve_free(curve_t **curve) {
 		if ((*curve)->order && isclone((*curve)->order)) {
 			gunclone((*curve)->order);
 		}
+		if ((*curve)->factors && isclone((*curve)->factors)) {
+			gunclone((*curve)->factors);
+		}
 
 		try_free(*curve);
 		*curve = NULL;
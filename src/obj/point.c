@@ -8,6 +8,7 @@ point_t *point_copy(const point_t *src, point_t *dest) {
 	if (src->point) dest->point = gcopy(src->point);
 	if (src->order) dest->order = gcopy(src->order);
 	if (src->cofactor) dest->cofactor = gcopy(src->cofactor);
+	if (src->factors) dest->factors = gclone(src->factors);
 	return dest;
 }
 
@@ -15,6 +16,7 @@ point_t *point_clone(const point_t *src, point_t *dest) {
 	if (src->point) dest->point = gclone(src->point);
 	if (src->order) dest->order = gclone(src->order);
 	if (src->cofactor) dest->cofactor = gclone(src->cofactor);
+	if (src->factors) dest->factors = gclone(src->factors);
 	return dest;
 }
 
@@ -29,6 +31,9 @@ void point_free(point_t **point) {
 		if ((*point)->cofactor && isclone((*point)->cofactor)) {
 			gunclone((*point)->cofactor);
 		}
+		if ((*point)->factors && isclone((*point)->factors)) {
+			gunclone((*point)->factors);
+		}
 		try_free(*point);
 		*point = NULL;
 	}
@@ -0,0 +1,68 @@
+/*
+ * ecgen, tool for generating Elliptic curve domain parameters
+ * Copyright (C) 2017-2018 J08nY
+ */
+#include "queue.h"
+#include "util/memory.h"
+
+queue_t *queue_new(size_t capacity) {
+	queue_t *queue = try_calloc(sizeof(queue_t));
+	queue->items = try_calloc(sizeof(void *) * capacity);
+	queue->capacity = capacity;
+	pthread_mutex_init(&queue->mutex, NULL);
+	pthread_cond_init(&queue->not_empty, NULL);
+	pthread_cond_init(&queue->not_full, NULL);
+	return queue;
+}
+
+bool queue_push(queue_t *queue, void *item) {
+	pthread_mutex_lock(&queue->mutex);
+	while (queue->count == queue->capacity && !queue->closed) {
+		pthread_cond_wait(&queue->not_full, &queue->mutex);
+	}
+	if (queue->closed) {
+		pthread_mutex_unlock(&queue->mutex);
+		return false;
+	}
+	size_t tail = (queue->head + queue->count) % queue->capacity;
+	queue->items[tail] = item;
+	queue->count++;
+	pthread_cond_signal(&queue->not_empty);
+	pthread_mutex_unlock(&queue->mutex);
+	return true;
+}
+
+void *queue_pop(queue_t *queue) {
+	pthread_mutex_lock(&queue->mutex);
+	while (queue->count == 0 && !queue->closed) {
+		pthread_cond_wait(&queue->not_empty, &queue->mutex);
+	}
+	void *item = NULL;
+	if (queue->count > 0) {
+		item = queue->items[queue->head];
+		queue->head = (queue->head + 1) % queue->capacity;
+		queue->count--;
+		pthread_cond_signal(&queue->not_full);
+	}
+	pthread_mutex_unlock(&queue->mutex);
+	return item;
+}
+
+void queue_close(queue_t *queue) {
+	pthread_mutex_lock(&queue->mutex);
+	queue->closed = true;
+	pthread_cond_broadcast(&queue->not_empty);
+	pthread_cond_broadcast(&queue->not_full);
+	pthread_mutex_unlock(&queue->mutex);
+}
+
+void queue_free(queue_t **queue) {
+	if (*queue) {
+		pthread_mutex_destroy(&(*queue)->mutex);
+		pthread_cond_destroy(&(*queue)->not_empty);
+		pthread_cond_destroy(&(*queue)->not_full);
+		try_free((*queue)->items);
+		try_free(*queue);
+		*queue = NULL;
+	}
+}
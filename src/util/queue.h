@@ -0,0 +1,68 @@
+/*
+ * ecgen, tool for generating Elliptic curve domain parameters
+ * Copyright (C) 2017-2018 J08nY
+ */
+/**
+ * @file queue.h
+ */
+#ifndef ECGEN_UTIL_QUEUE_H
+#define ECGEN_UTIL_QUEUE_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief A bounded, blocking, multi-producer multi-consumer queue of pointers.
+ * @param items ring buffer of queued items
+ * @param capacity maximum amount of queued items
+ * @param head index of the oldest queued item
+ * @param count amount of queued items
+ * @param closed whether the queue was closed for pushing
+ */
+typedef struct {
+	void **items;
+	size_t capacity;
+	size_t head;
+	size_t count;
+	bool closed;
+	pthread_mutex_t mutex;
+	pthread_cond_t not_empty;
+	pthread_cond_t not_full;
+} queue_t;
+
+/**
+ * @brief Create a new queue.
+ * @param capacity maximum amount of queued items, pushing blocks when reached
+ * @return
+ */
+queue_t *queue_new(size_t capacity);
+
+/**
+ * @brief Push an item to the queue, block while it is full.
+ * @param queue
+ * @param item
+ * @return whether the item was pushed, false if the queue is closed
+ */
+bool queue_push(queue_t *queue, void *item);
+
+/**
+ * @brief Pop the oldest item from the queue, block while it is empty.
+ * @param queue
+ * @return the item, or NULL if the queue is closed and empty
+ */
+void *queue_pop(queue_t *queue);
+
+/**
+ * @brief Close the queue, no more items can be pushed. Wakes up all waiters.
+ * @param queue
+ */
+void queue_close(queue_t *queue);
+
+/**
+ * @brief Free the queue, does not free the queued items.
+ * @param queue
+ */
+void queue_free(queue_t **queue);
+
+#endif  // ECGEN_UTIL_QUEUE_H
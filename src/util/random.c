@@ -7,6 +7,8 @@
 #include "random.h"
 #include <time.h>
 #include <stdint.h>
+#include "misc/config.h"
+#include "util/bits.h"
 
 void random_reseed(void) {
 	pari_ulong seed = 0;
@@ -35,8 +37,38 @@ void random_reseed(void) {
 	avma = ltop;
 }
 
+bool random_stream(unsigned long stream) {
+	if (!cfg->rng_seed) {
+		return false;
+	}
+
+	pari_sp ltop = avma;
+	bits_t *master = bits_from_hex(cfg->rng_seed);
+	bits_t *number = bits_from_i_len(utoi(stream), 64);
+	bits_t *data = bits_concat(master, number, NULL);
+	unsigned char hash[20];
+	bits_sha1(data, hash);
+	bits_free(&master);
+	bits_free(&number);
+	bits_free(&data);
+
+	pari_ulong seed = 0;
+	for (size_t i = 0; i < sizeof(pari_ulong); ++i) {
+		seed = (seed << 8) | hash[i];
+	}
+	// PARI wants a positive seed
+	if (seed == 0) {
+		seed = 1;
+	}
+	setrand(utoi(seed));
+	avma = ltop;
+	return true;
+}
+
 bool random_init(void) {
-	random_reseed();
+	if (!random_stream(0)) {
+		random_reseed();
+	}
 
 	return true;
 }
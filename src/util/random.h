@@ -14,7 +14,8 @@
 /**
  * @brief Init the PARI-GP random generator.
  *
- * Initializes the PARI-GP random generator, tries to do so from
+ * Initializes the PARI-GP random generator, from stream 0 of the
+ * <code>--rng-seed</code> if one was given. Otherwise tries to do so from
  * cryptographically strong sources(/dev/urandom) at first but falls back on
  * clock_gettime and time(NULL).
  *
@@ -22,6 +23,18 @@
  */
 bool random_init(void);
 
+/**
+ * @brief Seed the PARI-GP random generator with a stream derived from the
+ * <code>--rng-seed</code>.
+ *
+ * The seed of a stream is SHA-1(master seed || 64-bit stream number), so
+ * different streams are independent of each other.
+ *
+ * @param stream the stream number
+ * @return whether a master seed was given, if not nothing is done
+ */
+bool random_stream(unsigned long stream);
+
 /**
  * @brief Generate random <code>bits</code> sized prime.
  * @param bits the size of the prime to generate
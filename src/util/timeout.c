@@ -3,40 +3,123 @@
  * Copyright (C) 2017-2018 J08nY
  */
 #include "timeout.h"
-#include "util/memory.h"
+#include <signal.h>
+#include <stdint.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 
-__thread jmp_buf timeout_ptr;
-__thread bool timeout_in = false;
-__thread timer_t *timeout_timer;
-__thread struct sigevent *sevp;
+#define TIMEOUT_NSEC 1000000000LL
 
-void timeout_handle(int signum, siginfo_t *siginfo, void *other) {
-	sigset_t mask;
-	sigemptyset(&mask);
-	sigaddset(&mask, SIGALRM);
-	sigprocmask(SIG_UNBLOCK, &mask, NULL);
+static __thread timer_t timeout_timer;
+static __thread bool timeout_timer_created = false;
+/* Whether a timeout is running and when it runs out. */
+static __thread volatile bool timeout_in = false;
+static __thread volatile int64_t timeout_deadline = 0;
+/* When the timer fires next, 0 if it is not armed. */
+static __thread volatile int64_t timeout_fires = 0;
+/* When the whole run has to end, 0 if it does not. */
+static int64_t timeout_end = 0;
 
-	if (timeout_in) siglongjmp(timeout_ptr, 1);
+static int64_t timeout_now(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (int64_t)now.tv_sec * TIMEOUT_NSEC + now.tv_nsec;
+}
+
+static void timeout_arm(int64_t now, int64_t at) {
+	struct itimerspec timer_time = {
+	    .it_interval = {.tv_sec = 0, .tv_nsec = 0},
+	    .it_value = {.tv_sec = (at - now) / TIMEOUT_NSEC,
+	                 .tv_nsec = (at - now) % TIMEOUT_NSEC}};
+	timeout_fires = at;
+	timer_settime(timeout_timer, 0, &timer_time, NULL);
+}
+
+static void timeout_handle(int signum) {
+	if (!timeout_in) {
+		timeout_fires = 0;
+		return;
+	}
+	int64_t now = timeout_now();
+	if (now < timeout_deadline) {
+		// the timeout was restarted since the timer was armed
+		timeout_arm(now, timeout_deadline);
+		return;
+	}
+	if (PARI_SIGINT_block) {
+		// PARI raises the signal again once it leaves the critical section
+		PARI_SIGINT_pending = signum;
+		return;
+	}
+	timeout_in = false;
+	timeout_fires = 0;
+	pari_err(e_ALARM, "ecgen timeout");
+}
+
+void timeout_start(unsigned long seconds) {
+	if (!timeout_timer_created || (!seconds && !timeout_end)) return;
+	int64_t now = timeout_now();
+	int64_t deadline = timeout_end;
+	if (seconds) {
+		int64_t after = now + (int64_t)seconds * TIMEOUT_NSEC;
+		if (!deadline || after < deadline) {
+			deadline = after;
+		}
+	}
+	timeout_deadline = deadline;
+	timeout_in = true;
+	// a timer that fires before the deadline is re-armed then
+	if (!timeout_fires || timeout_fires > deadline) {
+		timeout_arm(now, deadline);
+	}
+}
+
+void timeout_stop(void) { timeout_in = false; }
+
+bool timeout_expired(void) {
+	return timeout_end && timeout_now() >= timeout_end;
+}
+
+bool timeout_expiring(double part) {
+	int64_t reserve = (int64_t)(part * cfg->deadline * TIMEOUT_NSEC);
+	return timeout_end && timeout_now() >= timeout_end - reserve;
 }
 
 void timeout_thread_init() {
-	timeout_timer = try_calloc(sizeof(timer_t));
-	sevp = try_calloc(sizeof(struct sigevent));
+	bool any = cfg->deadline != 0;
+	for (size_t i = 0; i < OFFSET_END; ++i) {
+		any |= cfg->timeout[i] != 0;
+	}
+	if (!any) return;
+	struct sigevent sevp = {0};
+	sevp.sigev_notify = SIGEV_THREAD_ID;
+	sevp.sigev_signo = SIGALRM;
+	sevp._sigev_un._tid = (__pid_t)syscall(SYS_gettid);
+	timeout_timer_created =
+	    timer_create(CLOCK_MONOTONIC, &sevp, &timeout_timer) == 0;
+	timeout_in = false;
+	timeout_fires = 0;
 }
 
 void timeout_thread_quit() {
-	try_free(timeout_timer);
-	try_free(sevp);
+	if (timeout_timer_created) {
+		timer_delete(timeout_timer);
+		timeout_timer_created = false;
+	}
 }
 
 bool timeout_init() {
+	if (cfg->deadline) {
+		timeout_end = timeout_now() + (int64_t)cfg->deadline * TIMEOUT_NSEC;
+	}
 	// init for the main thread.
 	timeout_thread_init();
 	struct sigaction new_action;
 
-	new_action.sa_sigaction = timeout_handle;
+	new_action.sa_handler = timeout_handle;
 	sigemptyset(&new_action.sa_mask);
-	new_action.sa_flags = SA_SIGINFO;
+	// the handler leaves through pari_err, so SIGALRM must not stay blocked
+	new_action.sa_flags = SA_NODEFER | SA_RESTART;
 
 	sigaction(SIGALRM, &new_action, NULL);
 	return true;
@@ -45,4 +128,4 @@ bool timeout_init() {
 void timeout_quit() {
 	// deinit the main thread.
 	timeout_thread_quit();
-}
\ No newline at end of file
+}
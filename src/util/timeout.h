@@ -8,57 +8,53 @@
 #ifndef ECGEN_UTIL_TIMEOUT_H
 #define ECGEN_UTIL_TIMEOUT_H
 
-#include <setjmp.h>
-#include <sys/syscall.h>
 #include <time.h>
-#include <unistd.h>
 #include "io/output.h"
 #include "misc/config.h"
 
-extern __thread sigjmp_buf timeout_ptr;
-extern __thread bool timeout_in;
-extern __thread timer_t *timeout_timer;
-extern __thread struct sigevent *sevp;
-
 /**
- * @brief Start a timer that times out after <code>seconds-</code>.
+ * @brief Start a timeout that runs out after <code>seconds</code>.
+ *
+ * The timeout is thread-local. If it runs out before <code>timeout_stop</code>
+ * is called, the PARI error <code>e_ALARM</code> is raised in the thread, so
+ * the timed code should run inside a <code>pari_CATCH(e_ALARM)</code> block.
+ * Like other PARI interrupts, the error is held back while PARI is in a
+ * critical section.
  *
- * The timer is thread-local. This function is an if-like statement,
- * it runs the <code>else</code> part for the duration of the timeout or
- * until <code>timeout_stop</code> is called. If that branch times out, then the
- * <code>if</code> part is run. The times should be always stopped by
- * <code>timeout_stop</code> when the timed interval ends.
- * @param seconds how long to run the <code>else</code> branch for
+ * The timer of the thread stays armed between timeouts and is only re-armed
+ * when it fires early, so starting and stopping a timeout does not usually
+ * make any syscalls.
+ * The timeout never runs past the deadline of the whole run.
+ * @param seconds how long the timeout is, 0 for only the deadline of the run
+ */
+void timeout_start(unsigned long seconds);
+
+/**
+ * @brief Stop the timeout of the thread.
+ */
+void timeout_stop(void);
+
+/**
+ * @brief Whether the deadline of the whole run(--deadline) has passed.
+ * @return
  */
-#define timeout_start(seconds)                                \
-	if ((seconds) != 0) {                                     \
-		sevp->sigev_notify = SIGEV_THREAD_ID;                 \
-		sevp->sigev_signo = SIGALRM;                          \
-		sevp->sigev_value.sival_int = 0;                      \
-		sevp->_sigev_un._tid = (__pid_t)syscall(SYS_gettid);  \
-                                                              \
-		timer_create(CLOCK_MONOTONIC, sevp, timeout_timer);   \
-		struct itimerspec timer_time = {                      \
-		    .it_interval = {.tv_sec = 0, .tv_nsec = 0},       \
-		    .it_value = {.tv_sec = (seconds), .tv_nsec = 0}}; \
-		timer_settime(*timeout_timer, 0, &timer_time, NULL);  \
-		timeout_in = true;                                    \
-	};                                                        \
-	if ((seconds) != 0 && sigsetjmp(timeout_ptr, 1) == 1)
+bool timeout_expired(void);
 
 /**
- * @brief Stop a timer.
+ * @brief Whether less than a part of the deadline of the whole run is left.
+ * @param part the part of the deadline, between 0 and 1
+ * @return
  */
-#define timeout_stop()                    \
-	{                                     \
-		if (timeout_in) {                 \
-			timeout_in = false;           \
-			timer_delete(*timeout_timer); \
-		}                                 \
-	}
+bool timeout_expiring(double part);
 
+/**
+ * @brief Initialize the timer of the calling thread.
+ */
 void timeout_thread_init();
 
+/**
+ * @brief Deinitialize the timer of the calling thread.
+ */
 void timeout_thread_quit();
 
 /**
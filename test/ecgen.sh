@@ -35,6 +35,10 @@ function json() {
 	assert_matches "${JSON} -x \\\"a\\\"" "0x02ed" "${f2m}"
 	assert_matches "${JSON} -x \\\"b\\\"" "0x00b7" "${f2m}"
 	assert_matches "${JSON} -x \\\"order\\\"" "0x3de" "${f2m}"
+
+	assert_raises "${ecgen} --fp --batch --input=data/fp_10_batch.csv.in 10"
+	assert_raises "${ecgen} --fp --batch --metadata --format=csv --input=data/fp_10_batch.csv.in 10"
+	assert_matches "wc -l" "3" "$(${ecgen} --fp --batch --format=ndjson --input=data/fp_10_batch.csv.in 10 2>/dev/null)"
 }
 
 function exhaustive() {
@@ -42,6 +46,8 @@ function exhaustive() {
 	assert_raises "${ecgen} --fp -r 10"
 	assert_raises "${ecgen} --f2m -r 10"
 	assert_raises "${ecgen} --fp -r -p 10"
+	assert_raises "${ecgen} --fp -r -p --prefilter 16"
+	assert_raises "${ecgen} --fp -r -k 4 --prefilter=7 16"
 	assert_raises "${ecgen} --f2m -r -u 10"
 	assert_raises "${ecgen} --fp -r -i -u 10"
 	assert_raises "${ecgen} --f2m -r -i -u 10"
@@ -59,6 +65,8 @@ function exhaustive() {
 	assert_raises "${ecgen} --fp -r --points=prime 10"
 	assert_raises "${ecgen} --fp -r --points=nonprime 10"
 	assert_raises "${ecgen} --fp -r --points=all 10"
+	assert_raises "${ecgen} --fp -r --points=all:2 10"
+	assert_raises "${ecgen} --fp -r --points=nonprime:2 10"
 	assert_raises "${ecgen} --fp -r --points=none 10"
 
 	assert_raises "${ecgen} --f2m -r --points=random 10"
@@ -71,6 +79,39 @@ function exhaustive() {
 	assert_raises "${ecgen} --fp --random=seed,field,a,b,equation 10"
 
 	assert_raises "${ecgen} --fp -r -c 5 10"
+	assert_raises "${ecgen} --fp -r -p -c 5 --threads=2 10"
+	assert_raises "${ecgen} --f2m -r -c 5 --threads=2 --ordered 10"
+	assert_raises "${ecgen} --fp -r -c 5 --threads=auto --points=all 10"
+	assert_raises "${ecgen} --fp -r -p --threads=4 16"
+	assert_raises "${ecgen} --fp -r -p -c 3 --timeout=1m 16"
+	assert_raises "${ecgen} --fp -r -p -c 5 --threads=2 --timeout=1m 16"
+	assert_raises "${ecgen} --fp -r -p -c 3 --timeout=order:30s,points:5s 16"
+	assert_raises "${JSON}" 0 "$(${ecgen} --fp -r -c 100 --deadline=1s 160 2>/dev/null)"
+	assert_raises "${JSON}" 0 "$(${ecgen} --fp -r -c 100 --threads=2 --deadline=1s 160 2>/dev/null)"
+
+	seeded=$(${ecgen} --fp -r -c 3 --rng-seed=0xabcd 16 2>/dev/null)
+	assert "${ecgen} --fp -r -c 3 --rng-seed=0xabcd 16 2>/dev/null" "${seeded}"
+	assert "${ecgen} --fp -r -c 3 --rng-seed=0xabcd --threads=2 --ordered 16 2>/dev/null" "${seeded}"
+
+	assert_raises "${ecgen} --fp -r -p --stats 10"
+	assert_raises "${ecgen} --fp -r -c 3 --threads=2 --stats 10"
+	stats=$(${ecgen} --fp -r -p --stats 10 2>&1 >/dev/null)
+	assert_raises "${JSON}" 0 "${stats}"
+	assert_matches "${JSON} -x \\\"curves\\\"" "1" "${stats}"
+
+	assert_raises "${ecgen} --fp -r -c 5 --flush=exit 10"
+	assert_raises "${ecgen} --fp -r -c 5 --threads=2 --flush=2 10"
+	assert_raises "${JSON}" 0 "$(${ecgen} --fp -r -c 5 --flush=exit 10 2>/dev/null)"
+
+	assert_raises "${ecgen} --fp -r -c 3 --format=ndjson 10"
+	assert_raises "${ecgen} --fp -r -c 3 --threads=2 --format=ndjson 10"
+	assert_matches "wc -l" "3" "$(${ecgen} --fp -r -c 3 --format=ndjson 10 2>/dev/null)"
+	assert_raises "${ecgen} --f2m -r -c 3 --format=binary 10"
+	assert_raises "${ecgen} --fp -r -c 3 --format=csv 10"
+	assert_raises "${ecgen} --f2m -r -c 3 --threads=2 --format=csv 10"
+	assert_matches "head -n 1" "p,a,b,x,y" "$(${ecgen} --fp -r --format=csv --columns=p,a,b,x,y 10 2>/dev/null)"
+	assert_matches "wc -l" "2" "$(${ecgen} --fp -r -u --format=csv 10 2>/dev/null)"
+	assert_raises "${ecgen} --fp -r -c 3 --threads=2 --format=binary 10"
 
 	assert_raises "${ecgen} --fp -r --metadata 10"
 	assert_raises "${ecgen} --f2m -r --metadata 10"
@@ -93,6 +134,7 @@ function brainpool() {
 function anomalous() {
 	start_test
 	assert_raises "${ecgen} --fp --anomalous -r 20"
+	assert_raises "${ecgen} --fp --anomalous -r -c 3 --threads=2 20"
 	out=$(${ecgen} --fp --anomalous -r 20 2>/dev/null)
 	p=$(echo $out | ${JSON} -x field\",\"p | cut -f 2)
 	order=$(echo $out | ${JSON} -x ^0,\"order\" | cut -f 2)
@@ -102,6 +144,7 @@ function anomalous() {
 function supersingular() {
     start_test
     assert_raises "${ecgen} --fp --supersingular -r -c 5 20"
+    assert_raises "${ecgen} --fp --supersingular -r -c 5 --threads=2 20"
     out=$(${ecgen} --fp --supersingular -r 20 2>/dev/null)
 	p=$(echo $out | ${JSON} -x field\",\"p | cut -f 2)
 	order=$(echo $out | ${JSON} -x ^0,\"order\" | cut -f 2)
@@ -128,6 +171,19 @@ function invalid() {
 	assert_raises "${ecgen} --f2m --threads=2 -r -i -u 10"
 	assert_raises "${ecgen} --fp --threads=auto -r -i -u 10"
 	assert_raises "${ecgen} --f2m --threads=auto -r -i -u 10"
+	assert_raises "${ecgen} --fp -r -i --prefilter=7 16"
+	assert_raises "${ecgen} --fp --threads=2 -r -i --prefilter 16"
+	# every target prime is up to the bound, so the screen rejects curves
+	screened=$(${ecgen} --fp -r -i2-7 --prefilter=7 -v 16 2>&1 >/dev/null)
+	assert_matches "grep -c Pre-filter.rejected.[1-9]" "1" "${screened}"
+	assert_raises "${ecgen} --fp -r -i --invalid-twists 16"
+	assert_raises "${ecgen} --fp --threads=2 -r -i --invalid-twists=any 16"
+	assert_raises "${ecgen} --f2m -r -i --invalid-twists=any 10"
+	assert_raises "${ecgen} --fp -r -i --invalid-plan 16"
+	assert_raises "${ecgen} --fp -r -i5-15 --invalid-plan --invalid-twists 16"
+	assert_raises "${ecgen} --fp -i --batch --input=data/fp_10_batch.csv.in 10"
+	assert_raises "${ecgen} --fp --threads=2 -i --batch --input=data/fp_10_batch.csv.in 10"
+	assert_matches "grep -c ^\\[" "3" "$(${ecgen} --fp --threads=2 -i --batch --input=data/fp_10_batch.csv.in 10 2>/dev/null)"
 }
 
 function twist() {
@@ -140,7 +196,19 @@ function cli() {
 	start_test
 	assert_raises "${ecgen} --threads=a" 1
 	assert_raises "${ecgen} --koblitz=2" 1
+	assert_raises "${ecgen} --fp -r --prefilter 10" 1
+	assert_raises "${ecgen} --fp -r -p --prefilter=1 10" 1
+	assert_raises "${ecgen} --f2m -r -p --prefilter 10" 1
+	assert_raises "${ecgen} --fp --order=101 -p --prefilter 10" 1
+	assert_raises "${ecgen} --fp -r --invalid-twists 10" 1
+	assert_raises "${ecgen} --fp -r -i --invalid-twists=some 10" 1
+	assert_raises "${ecgen} --fp -r --invalid-plan 10" 1
+	assert_raises "${ecgen} --fp -r -i --invalid-plan --threads=2 10" 1
 	assert_raises "${ecgen} --points=something" 1
+	assert_raises "${ecgen} --fp -i --stats 10" 1
+	assert_raises "${ecgen} --fp --anomalous --stats 10" 1
+	assert_raises "${ecgen} --fp -r --points=all:0 10" 1
+	assert_raises "${ecgen} --fp -r --points=all:x 10" 1
 	assert_raises "${ecgen} --seed=some" 64
 	assert_raises "${ecgen} 1 2 3" 64
 	assert_raises "${ecgen} --fp --f2m 1" 1
@@ -149,11 +217,36 @@ function cli() {
 	assert_raises "${ecgen} --brainpool-rfc=01234 --fp 10" 1
 	assert_raises "${ecgen} --ansi=01234 --fp 10" 1
 	assert_raises "${ecgen} --hex-check=not_hex --fp 10" 1
+	assert_raises "${ecgen} --rng-seed=not_hex --fp -r 10" 1
+	assert_raises "${ecgen} --flush=0 --fp -r 10" 1
+	assert_raises "${ecgen} --format=xml --fp -r 10" 1
+	assert_raises "${ecgen} --columns=p,a --fp -r 10" 1
+	assert_raises "${ecgen} --batch --fp -r 10" 1
+	assert_raises "${ecgen} --timeout=frobnicate:1s --fp -r 10" 1
+	assert_raises "${ecgen} --deadline=0 --fp -r 10" 1
+	assert_raises "${ecgen} --format=csv --columns=p,z --fp -r 10" 1
+	assert_raises "${ecgen} --flush=sometimes --fp -r 10" 1
 	assert_raises "${ecgen} abc" 1
 	assert_raises "${ecgen} --supersingular --f2m 10" 1
 	assert_raises "${ecgen} --fp --order=not_a_number 32" 1
 }
 
+function checkpoint() {
+	start_test
+	dir=$(mktemp -d)
+	assert_raises "${ecgen} --fp -r -c 2 --output=${dir}/out.json --checkpoint=${dir}/cp.json 10"
+	assert_raises "${JSON}" 0 "$(cat ${dir}/cp.json)"
+	assert_matches "${JSON} -x \\\"emitted\\\"" "2" "$(cat ${dir}/cp.json)"
+	assert_raises "${ecgen} --fp -r -c 4 --output=${dir}/out.json --checkpoint=${dir}/cp.json --resume 10"
+	assert_raises "${JSON}" 0 "$(cat ${dir}/out.json)"
+	assert_matches "${JSON} -x \\\"emitted\\\"" "4" "$(cat ${dir}/cp.json)"
+	assert_raises "${ecgen} --fp -r -c 6 --threads=2 --output=${dir}/out.json --checkpoint=${dir}/cp.json --resume 10"
+	assert_raises "${JSON}" 0 "$(cat ${dir}/out.json)"
+	assert_raises "${ecgen} --fp -r --checkpoint=${dir}/cp.json 10" 1
+	assert_raises "${ecgen} --fp -r --output=${dir}/out.json --resume 10" 1
+	rm -rf ${dir}
+}
+
 function hex() {
 	start_test
 	assert_raises "${ecgen} --fp -r --hex-check=\"abc\" 32 | grep \"abc\""
@@ -206,6 +299,7 @@ supersingular
 invalid
 twist
 cli
+checkpoint
 hex
 cm
 secg
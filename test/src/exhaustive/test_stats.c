@@ -0,0 +1,52 @@
+/*
+ * ecgen, tool for generating Elliptic curve domain parameters
+ * Copyright (C) 2017-2018 J08nY
+ */
+
+#include <criterion/criterion.h>
+#include <parson/parson.h>
+#include "exhaustive/stats.h"
+#include "test/default.h"
+#include "util/memory.h"
+
+TestSuite(stats, .init = default_setup, .fini = default_teardown);
+
+Test(stats, test_stats_merge) {
+	stats_t to = {0};
+	stats_t from = {0};
+	from.curves = 2;
+	from.states[OFFSET_ORDER].calls = 5;
+	from.states[OFFSET_ORDER].backtracks = 3;
+	from.states[OFFSET_ORDER].wall = 1.5;
+
+	stats_merge(&to, &from);
+	stats_merge(&to, &from);
+	cr_assert_eq(to.curves, 4, );
+	cr_assert_eq(to.states[OFFSET_ORDER].calls, 10, );
+	cr_assert_eq(to.states[OFFSET_ORDER].backtracks, 6, );
+	cr_assert_float_eq(to.states[OFFSET_ORDER].wall, 3.0, 1e-9, );
+	cr_assert_eq(to.states[OFFSET_FIELD].calls, 0, );
+}
+
+Test(stats, test_stats_json) {
+	stats_t stats = {0};
+	stats.curves = 1;
+	stats.states[OFFSET_CURVE].calls = 7;
+	stats.states[OFFSET_CURVE].rejections = 6;
+
+	char *json = stats_json(&stats, 2.0, 1.0);
+	JSON_Value *value = json_parse_string(json);
+	cr_assert_not_null(value, );
+	JSON_Object *object = json_value_get_object(value);
+	cr_assert_float_eq(json_object_get_number(object, "curves"), 1, 1e-9, );
+	cr_assert_float_eq(json_object_get_number(object, "wall"), 2.0, 1e-9, );
+	cr_assert_float_eq(
+	    json_object_dotget_number(object, "states.curve.calls"), 7, 1e-9, );
+	cr_assert_float_eq(
+	    json_object_dotget_number(object, "states.curve.rejections"), 6, 1e-9,
+	    );
+	cr_assert(json_object_dothas_value(object, "states.metadata"), );
+
+	json_value_free(value);
+	try_free(json);
+}
@@ -3,6 +3,7 @@
  * Copyright (C) 2017-2018 J08nY
  */
 #include <criterion/criterion.h>
+#include "exhaustive/arg.h"
 #include "gen/curve.h"
 #include "obj/curve.h"
 #include "test/default.h"
@@ -34,4 +35,56 @@ Test(curve, test_curve_clone) {
 	cr_assert_not_null(other, );
 	curve_free(&curve);
 	curve_free(&other);
-}
\ No newline at end of file
+}
+
+Test(curve, test_curve_gen_template) {
+	curve_t curve = {.field = stoi(23), .a = stoi(5), .b = stoi(1)};
+	GEN template = curve_template_new(&curve);
+	cr_assert_not_null(template, );
+
+	arg_t arg = {.args = template};
+	int ret = curve_gen_template(&curve, &arg, OFFSET_CURVE);
+	cr_assert_eq(ret, 1, );
+	GEN expected = ellinit(mkvec2(stoi(5), stoi(1)), stoi(23), -1);
+	for (long i = 1; i <= 13; ++i) {
+		cr_assert(gidentical(gel(curve.curve, i), gel(expected, i)), );
+	}
+	cr_assert(equalii(ellcard(curve.curve, NULL), stoi(31)), );
+
+	// 4 * 5^3 + 27 * 6^2 = 0 (mod 23)
+	curve.b = stoi(6);
+	ret = curve_gen_template(&curve, &arg, OFFSET_CURVE);
+	cr_assert_eq(ret, -3, );
+	curve_template_free(&template);
+	cr_assert_null(template, );
+}
+
+Test(curve, test_curve_gen_template_order) {
+	GEN p = stoi(1009);
+	curve_t curve = {.field = p, .a = mkintmod(stoi(7), p)};
+	GEN template = curve_template_new(&curve);
+	cr_assert_not_null(template, );
+	arg_t arg = {.args = template};
+
+	for (long b = 2; b < 40; ++b) {
+		curve.b = mkintmod(stoi(b), p);
+		GEN expected = ellinit(mkvec2(curve.a, curve.b), p, -1);
+		int ret = curve_gen_template(&curve, &arg, OFFSET_CURVE);
+		if (glength(expected) == 0) {
+			cr_assert_eq(ret, -3, );
+			continue;
+		}
+		cr_assert_eq(ret, 1, );
+		for (long i = 1; i < lg(expected) - 1; ++i) {
+			cr_assert(gidentical(gel(curve.curve, i), gel(expected, i)), );
+		}
+		GEN order = ellcard(expected, NULL);
+		cr_assert(equalii(ellcard(curve.curve, NULL), order), );
+
+		GEN point = ellrandom(expected);
+		cr_assert(ellisoncurve(curve.curve, point), );
+		cr_assert(equalii(ellorder(curve.curve, point, order),
+		                  ellorder(expected, point, order)), );
+	}
+	curve_template_free(&template);
+}
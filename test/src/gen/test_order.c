@@ -107,4 +107,22 @@ Test(order, test_order_check_discriminant) {
 	arg.args = nok_disc;
 	ret = order_check_discriminant(&curve, &arg, OFFSET_ORDER);
 	cr_assert_eq(ret, -4, );
-}
\ No newline at end of file
+}
+
+Test(order, test_order_factors) {
+	curve_t curve = {.field = stoi(19),
+	                 .a = mkintmodu(3, 19),
+	                 .b = mkintmodu(5, 19),
+	                 .curve = ellinit(mkvec2(stoi(3), stoi(5)), stoi(19), 0),
+	                 .order = stoi(26)};
+
+	pari_sp to = avma;
+	GEN factors = order_factors(&curve);
+	pari_sp from = avma;
+	cr_assert(gequal(factors, Z_factor(stoi(26))), );
+	cr_assert_eq(order_factors(&curve), factors, );
+
+	int ret = order_unroll(&curve, from, to);
+	cr_assert_eq(ret, -1, );
+	cr_assert_null(curve.factors, );
+}
@@ -238,3 +238,27 @@ Test(point, test_points_nonprime) {
 
 	curve_free(&curve);
 }
+
+Test(point, test_points_from_orders) {
+	curve_t *curve = new_test_curve();
+	point_t *generator = curve->generators[0]->generator;
+	GEN orders = mkvec4s(27, 2, 3, 9);
+	point_t **points = points_from_orders(curve->curve, generator, orders);
+
+	cr_assert_not_null(points, "Points are null.");
+	cr_assert_null(points[1], "Point of non-dividing order generated.");
+	for (size_t i = 0; i < 4; i++) {
+		if (i == 1) continue;
+		point_t *point = points[i];
+		cr_assert_not_null(point, "Point is null.");
+		cr_assert(gequal(point->order, gel(orders, i + 1)),
+		          "Point has wrong order set.");
+		GEN mul = diviiexact(generator->order, point->order);
+		cr_assert(gequal(point->point,
+		                 ellmul(curve->curve, generator->point, mul)),
+		          "Point is not the generator multiple.");
+	}
+
+	points_free_deep(&points, 4);
+	curve_free(&curve);
+}
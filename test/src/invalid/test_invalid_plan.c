@@ -0,0 +1,70 @@
+/*
+ * ecgen, tool for generating Elliptic curve domain parameters
+ * Copyright (C) 2017-2018 J08nY
+ */
+
+#include <criterion/criterion.h>
+#include "invalid/invalid_plan.h"
+#include "test/default.h"
+
+TestSuite(invalid_plan, .init = default_setup, .fini = default_teardown);
+
+static bool plan_add_order(plan_t *plan, long order) {
+	return plan_add(plan, gen_0, gen_1, stoi(order));
+}
+
+Test(invalid_plan, test_plan_pick_all) {
+	pari_ulong primes[] = {2, 3, 5, 7};
+	plan_t *plan = plan_new(primes, 4, 0, 8);
+	size_t picks[8];
+
+	cr_assert_not(plan_add_order(plan, 11), );
+	cr_assert(plan_add_order(plan, 10), );
+	cr_assert(plan_add_order(plan, 6), );
+	cr_assert_eq(plan_pick(plan, picks, false), 0, );
+	cr_assert_eq(plan_pick(plan, picks, true), 2, );
+
+	// 35 covers two primes at once, 10 is not needed anymore
+	cr_assert(plan_add_order(plan, 35), );
+	cr_assert_eq(plan_pick(plan, picks, false), 2, );
+	cr_assert(equalis(plan_get(plan, picks[0])->order, 35), );
+	cr_assert(equalis(plan_get(plan, picks[1])->order, 6), );
+
+	pari_ulong covered[4];
+	cr_assert_eq(plan_take(plan, picks[0], covered), 2, );
+	cr_assert_eq(plan_take(plan, picks[1], covered), 2, );
+	cr_assert(plan_complete(plan), );
+	plan_free(&plan);
+	cr_assert_null(plan, );
+}
+
+Test(invalid_plan, test_plan_pick_target) {
+	// 7 does not come up, 11 and 13 replace it
+	pari_ulong primes[] = {2, 3, 5, 7, 11, 13};
+	plan_t *plan = plan_new(primes, 6, 10, 8);
+	size_t picks[8];
+
+	cr_assert(plan_add_order(plan, 30), );
+	cr_assert_eq(plan_pick(plan, picks, false), 0, );
+	cr_assert(plan_add_order(plan, 143), );
+	cr_assert_eq(plan_pick(plan, picks, false), 2, );
+	cr_assert(equalis(plan_get(plan, picks[0])->order, 143), );
+
+	pari_ulong covered[6];
+	cr_assert_eq(plan_take(plan, picks[0], covered), 2, );
+	cr_assert_not(plan_complete(plan), );
+	cr_assert_eq(plan_uncovered(plan, covered), 4, );
+	plan_free(&plan);
+}
+
+Test(invalid_plan, test_plan_full) {
+	pari_ulong primes[] = {2, 3, 5};
+	plan_t *plan = plan_new(primes, 3, 0, 1);
+
+	cr_assert(plan_add_order(plan, 2), );
+	// replaces the candidate covering less
+	cr_assert(plan_add_order(plan, 15), );
+	cr_assert_not(plan_add_order(plan, 3), );
+	cr_assert(equalis(plan_get(plan, 0)->order, 15), );
+	plan_free(&plan);
+}
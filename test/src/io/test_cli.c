@@ -56,20 +56,103 @@ Test(cli, test_auto_threads) {
 	cr_assert_eq(cfg->threads, sysconf(_SC_NPROCESSORS_ONLN), );
 }
 
+Test(cli, test_prefilter) {
+	int argc = 5;
+	char *argv[] = {"ecgen", "--prefilter", "-p", "--fp", "1"};
+	int ret = argp_parse(&test_argp, argc, argv, 0, 0, cfg);
+	cr_assert_eq(ret, 0, );
+	cr_assert(cfg->prefilter, );
+	cr_assert_eq(cfg->prefilter_bound, 3, );
+
+	char *argx[] = {"ecgen", "--prefilter=11", "-p", "--fp", "1"};
+	ret = argp_parse(&test_argp, argc, argx, 0, 0, cfg);
+	cr_assert_eq(ret, 0, );
+	cr_assert_eq(cfg->prefilter_bound, 11, );
+}
+
+Test(cli, test_flush) {
+	int argc = 4;
+	char *argv[] = {"ecgen", "--flush=exit", "--fp", "1"};
+	int ret = argp_parse(&test_argp, argc, argv, 0, 0, cfg);
+	cr_assert_eq(ret, 0, );
+	cr_assert_eq(cfg->flush, FLUSH_EXIT, );
+
+	char *argx[] = {"ecgen", "--flush=10", "--fp", "1"};
+	ret = argp_parse(&test_argp, argc, argx, 0, 0, cfg);
+	cr_assert_eq(ret, 0, );
+	cr_assert_eq(cfg->flush, FLUSH_EVERY, );
+	cr_assert_eq(cfg->flush_every, 10, );
+}
+
+Test(cli, test_format) {
+	int argc = 4;
+	char *argv[] = {"ecgen", "--format=ndjson", "--fp", "1"};
+	int ret = argp_parse(&test_argp, argc, argv, 0, 0, cfg);
+	cr_assert_eq(ret, 0, );
+	cr_assert_eq(cfg->format, FORMAT_NDJSON, );
+
+	char *argx[] = {"ecgen", "--format=binary", "--fp", "1"};
+	ret = argp_parse(&test_argp, argc, argx, 0, 0, cfg);
+	cr_assert_eq(ret, 0, );
+	cr_assert_eq(cfg->format, FORMAT_BINARY, );
+}
+
+Test(cli, test_batch) {
+	int argc = 5;
+	char *argv[] = {"ecgen", "--batch", "--input=curves.csv", "--fp", "1"};
+	int ret = argp_parse(&test_argp, argc, argv, 0, 0, cfg);
+	cr_assert_eq(ret, 0, );
+	cr_assert(cfg->batch, );
+	cr_assert_str_eq(cfg->input, "curves.csv", );
+}
+
+Test(cli, test_columns) {
+	int argc = 5;
+	char *argv[] = {"ecgen", "--format=csv", "--columns=p,a,b", "--fp", "1"};
+	int ret = argp_parse(&test_argp, argc, argv, 0, 0, cfg);
+	cr_assert_eq(ret, 0, );
+	cr_assert_eq(cfg->format, FORMAT_CSV, );
+	cr_assert_str_eq(cfg->columns, "p,a,b", );
+}
+
 Test(cli, test_timeout) {
 	int argc = 4;
 	char *argv[] = {"ecgen", "--timeout=10m", "--fp", "1"};
 	int ret = argp_parse(&test_argp, argc, argv, 0, 0, cfg);
 	cr_assert_eq(ret, 0, );
-	cr_assert_eq(cfg->timeout, 600, );
+	cr_assert_eq(cfg->timeout[OFFSET_ORDER], 600, );
 
 	char *argx[] = {"ecgen", "--timeout=1h", "--fp", "1"};
 	ret = argp_parse(&test_argp, argc, argx, 0, 0, cfg);
 	cr_assert_eq(ret, 0, );
-	cr_assert_eq(cfg->timeout, 3600, );
+	cr_assert_eq(cfg->timeout[OFFSET_ORDER], 3600, );
 
 	char *argy[] = {"ecgen", "--timeout=1d", "--fp", "1"};
 	ret = argp_parse(&test_argp, argc, argy, 0, 0, cfg);
 	cr_assert_eq(ret, 0, );
-	cr_assert_eq(cfg->timeout, 86400, );
+	cr_assert_eq(cfg->timeout[OFFSET_ORDER], 86400, );
+}
+
+Test(cli, test_timeout_states) {
+	int argc = 4;
+	char *argv[] = {"ecgen", "--timeout=1m,order:30s,points:5", "--fp", "1"};
+	int ret = argp_parse(&test_argp, argc, argv, 0, 0, cfg);
+	cr_assert_eq(ret, 0, );
+	cr_assert_eq(cfg->timeout[OFFSET_ORDER], 30, );
+	cr_assert_eq(cfg->timeout[OFFSET_POINTS], 5, );
+	cr_assert_eq(cfg->timeout[OFFSET_GENERATORS], 60, );
+
+	char *argx[] = {"ecgen", "--timeout=generators:10s", "--fp", "1"};
+	ret = argp_parse(&test_argp, argc, argx, 0, 0, cfg);
+	cr_assert_eq(ret, 0, );
+	cr_assert_eq(cfg->timeout[OFFSET_GENERATORS], 10, );
+	cr_assert_eq(cfg->timeout[OFFSET_ORDER], 0, );
+}
+
+Test(cli, test_deadline) {
+	int argc = 4;
+	char *argv[] = {"ecgen", "--deadline=2m", "--fp", "1"};
+	int ret = argp_parse(&test_argp, argc, argv, 0, 0, cfg);
+	cr_assert_eq(ret, 0, );
+	cr_assert_eq(cfg->deadline, 120, );
 }
\ No newline at end of file
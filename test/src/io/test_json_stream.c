@@ -0,0 +1,96 @@
+/*
+ * ecgen, tool for generating Elliptic curve domain parameters
+ * Copyright (C) 2017-2018 J08nY
+ */
+
+#include <criterion/criterion.h>
+#include <parson/parson.h>
+#include "io/json_stream.h"
+#include "test/default.h"
+#include "util/memory.h"
+
+TestSuite(json_stream, .init = default_setup, .fini = default_teardown);
+
+static void json_stream_fill(json_stream_t *stream, JSON_Value *root) {
+	JSON_Object *root_object = json_value_get_object(root);
+	json_stream_object_begin(stream);
+
+	json_object_dotset_string(root_object, "field.p", "0x17");
+	json_stream_key(stream, "field");
+	json_stream_object_begin(stream);
+	json_stream_key_string(stream, "p", "0x17");
+	json_stream_object_end(stream);
+
+	json_object_set_string(root_object, "seed", "a/b\"c\\\n\x01");
+	json_stream_key_string(stream, "seed", "a/b\"c\\\n\x01");
+
+	JSON_Value *gens_value = json_value_init_array();
+	JSON_Array *gens_array = json_value_get_array(gens_value);
+	json_stream_key(stream, "subgroups");
+	json_stream_array_begin(stream);
+	for (size_t i = 0; i < 2; ++i) {
+		JSON_Value *gen_value = json_value_init_object();
+		JSON_Object *gen_object = json_value_get_object(gen_value);
+		json_stream_object_begin(stream);
+		json_object_set_string(gen_object, "x", "0x01");
+		json_stream_key_string(stream, "x", "0x01");
+		if (i) {
+			JSON_Value *points_value = json_value_init_array();
+			JSON_Array *points_array = json_value_get_array(points_value);
+			json_stream_key(stream, "points");
+			json_stream_array_begin(stream);
+			for (size_t j = 0; j < 3; ++j) {
+				JSON_Value *point_value = json_value_init_object();
+				json_object_set_string(json_value_get_object(point_value), "y",
+				                       "0x02");
+				json_array_append_value(points_array, point_value);
+				json_stream_object_begin(stream);
+				json_stream_key_string(stream, "y", "0x02");
+				json_stream_object_end(stream);
+			}
+			json_object_set_value(gen_object, "points", points_value);
+			json_stream_array_end(stream);
+		}
+		json_array_append_value(gens_array, gen_value);
+		json_stream_object_end(stream);
+	}
+	json_object_set_value(root_object, "subgroups", gens_value);
+	json_stream_array_end(stream);
+
+	json_object_set_value(root_object, "empty", json_value_init_array());
+	json_stream_key(stream, "empty");
+	json_stream_array_begin(stream);
+	json_stream_array_end(stream);
+
+	json_stream_object_end(stream);
+}
+
+Test(json_stream, test_json_stream_pretty) {
+	JSON_Value *root = json_value_init_object();
+	json_stream_t stream;
+	json_stream_init(&stream, true);
+	json_stream_fill(&stream, root);
+
+	char *expected = json_serialize_to_string_pretty(root);
+	char *result = json_stream_finish(&stream);
+	cr_assert_str_eq(result, expected, );
+
+	json_free_serialized_string(expected);
+	json_value_free(root);
+	try_free(result);
+}
+
+Test(json_stream, test_json_stream_compact) {
+	JSON_Value *root = json_value_init_object();
+	json_stream_t stream;
+	json_stream_init(&stream, false);
+	json_stream_fill(&stream, root);
+
+	char *expected = json_serialize_to_string(root);
+	char *result = json_stream_finish(&stream);
+	cr_assert_str_eq(result, expected, );
+
+	json_free_serialized_string(expected);
+	json_value_free(root);
+	try_free(result);
+}
@@ -0,0 +1,123 @@
+/*
+ * ecgen, tool for generating Elliptic curve domain parameters
+ * Copyright (C) 2017-2018 J08nY
+ */
+
+#include <criterion/criterion.h>
+#include "io/output.h"
+#include "misc/config.h"
+#include "obj/curve.h"
+#include "obj/point.h"
+#include "obj/subgroup.h"
+#include "test/default.h"
+#include "util/memory.h"
+
+TestSuite(output, .init = default_setup, .fini = default_teardown);
+
+static size_t binary_u32(const unsigned char **data) {
+	const unsigned char *u = *data;
+	*data += 4;
+	return (size_t)u[0] << 24 | (size_t)u[1] << 16 | (size_t)u[2] << 8 |
+	       (size_t)u[3];
+}
+
+static GEN binary_int(const unsigned char **data) {
+	size_t len = binary_u32(data);
+	GEN result = gen_0;
+	for (size_t i = 0; i < len; ++i) {
+		result = addiu(shifti(result, 8), (*data)[i]);
+	}
+	*data += len;
+	return result;
+}
+
+static void binary_point(const unsigned char **data, GEN x, GEN y, GEN order,
+                         GEN cofactor) {
+	cr_assert(equalii(binary_int(data), x), "Wrong point x.");
+	cr_assert(equalii(binary_int(data), y), "Wrong point y.");
+	cr_assert(equalii(binary_int(data), order), "Wrong point order.");
+	if (cofactor) {
+		cr_assert(equalii(binary_int(data), cofactor), "Wrong cofactor.");
+	} else {
+		cr_assert_eq(binary_u32(data), 0, "Unknown cofactor not empty.");
+	}
+}
+
+Test(output, test_output_sbinary) {
+	cfg->field = FIELD_PRIME;
+	curve_t *curve = curve_new();
+	curve->field = stoi(23);
+	curve->a = mkintmodu(1, 23);
+	curve->b = mkintmodu(3, 23);
+	curve->curve = ellinit(mkvec2s(1, 3), stoi(23), -1);
+	curve->order = stoi(27);
+
+	point_t *gen = point_new();
+	gen->point = mkvec2(mkintmodu(15, 23), mkintmodu(14, 23));
+	gen->order = stoi(27);
+	gen->cofactor = stoi(1);
+	point_t *point = point_new();
+	point->point = ellmul(curve->curve, gen->point, stoi(9));
+	point->order = stoi(3);
+	subgroup_t *subgroup = subgroup_new();
+	subgroup->generator = gen;
+	subgroup->npoints = 1;
+	subgroup->points = points_new(1);
+	subgroup->points[0] = point;
+	curve->generators = subgroups_new(1);
+	curve->generators[0] = subgroup;
+	curve->ngens = 1;
+
+	char *output = output_sbinary(curve);
+	cr_assert_not_null(output, );
+	const unsigned char *data = (const unsigned char *)output;
+	size_t len = binary_u32(&data);
+	const unsigned char *end = data + len;
+
+	cr_assert_eq(*data++, 0, "Wrong field type.");
+	cr_assert(equalii(binary_int(&data), stoi(23)), "Wrong field.");
+	cr_assert_eq(binary_u32(&data), 0, "Seed not empty.");
+	cr_assert(equalii(binary_int(&data), stoi(1)), "Wrong a.");
+	cr_assert(equalii(binary_int(&data), stoi(3)), "Wrong b.");
+	cr_assert(equalii(binary_int(&data), stoi(27)), "Wrong order.");
+
+	cr_assert_eq(binary_u32(&data), 1, "Wrong number of subgroups.");
+	binary_point(&data, stoi(15), stoi(14), stoi(27), stoi(1));
+	cr_assert_eq(binary_u32(&data), 1, "Wrong number of points.");
+	binary_point(&data, lift(gel(point->point, 1)),
+	             lift(gel(point->point, 2)), stoi(3), NULL);
+	cr_assert_eq(data, end, "Record length does not match its contents.");
+
+	try_free(output);
+	curve_free(&curve);
+}
+
+Test(output, test_output_sbinary_zero) {
+	cfg->field = FIELD_PRIME;
+	curve_t *curve = curve_new();
+	curve->field = stoi(257);
+	curve->a = mkintmodu(0, 257);
+	curve->b = mkintmodu(256, 257);
+	curve->order = gen_0;
+
+	char *output = output_sbinary(curve);
+	const unsigned char *data = (const unsigned char *)output;
+	size_t len = binary_u32(&data);
+	const unsigned char *end = data + len;
+
+	cr_assert_eq(*data++, 0, "Wrong field type.");
+	// 257 takes two bytes, zero takes none
+	cr_assert_eq(binary_u32(&data), 2, );
+	cr_assert_eq(data[0], 1, );
+	cr_assert_eq(data[1], 1, );
+	data += 2;
+	cr_assert_eq(binary_u32(&data), 0, "Seed not empty.");
+	cr_assert_eq(binary_u32(&data), 0, "Zero a not empty.");
+	cr_assert(equalii(binary_int(&data), stoi(256)), "Wrong b.");
+	cr_assert_eq(binary_u32(&data), 0, "Zero order not empty.");
+	cr_assert_eq(binary_u32(&data), 0, "Wrong number of subgroups.");
+	cr_assert_eq(data, end, "Record length does not match its contents.");
+
+	try_free(output);
+	curve_free(&curve);
+}
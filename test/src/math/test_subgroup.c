@@ -28,13 +28,68 @@ Test(subgroup, test_prime_prime) {
 }
 
 Test(subgroup, test_nonprime_factors) {
-	GEN divs = subgroups_nonprime(stoi(27));
+	GEN divs = subgroups_nonprime(stoi(27), 0);
 	GEN vec = mkvec2s(9, 27);
 	cr_assert(gequal(divs, vec), "Factors not equal!");
 }
 
 Test(subgroup, test_all_factors) {
-	GEN divs = subgroups_all(stoi(27));
+	GEN divs = subgroups_all(stoi(27), 0);
 	GEN vec = mkvec3s(3, 9, 27);
 	cr_assert(gequal(divs, vec), "Factors not equal!");
-}
\ No newline at end of file
+}
+
+Test(subgroup, test_factors) {
+	GEN factors = Z_factor(stoi(108));
+	GEN fact = subgroups_factors(factors, stoi(18));
+	cr_assert(gequal(fact, Z_factor(stoi(18))), "Factors not equal!");
+}
+
+Test(subgroup, test_factored_all) {
+	GEN divs = subgroups_all(Z_factor(stoi(27)), 0);
+	GEN vec = mkvec3s(3, 9, 27);
+	cr_assert(gequal(divs, vec), "Factors not equal!");
+}
+
+Test(subgroup, test_factored_prime) {
+	cr_assert_null(subgroups_nonprime(Z_factor(stoi(5)), 0), );
+	GEN divs = subgroups_prime(Z_factor(stoi(12)));
+	GEN vec = mkvec2s(2, 3);
+	cr_assert(gequal(divs, vec), "Factors not equal!");
+}
+
+Test(subgroup, test_all_distinct) {
+	GEN divs = subgroups_all(stoi(36), 0);
+	GEN vec = mkvecn(8, stoi(2), stoi(3), stoi(4), stoi(6), stoi(9), stoi(12),
+	                 stoi(18), stoi(36));
+	cr_assert(gequal(divs, vec), "Factors not equal!");
+}
+
+Test(subgroup, test_all_max) {
+	GEN divs = subgroups_all(stoi(36), 3);
+	GEN vec = mkvec3s(2, 3, 4);
+	cr_assert(gequal(divs, vec), "Factors not equal!");
+}
+
+Test(subgroup, test_nonprime_max) {
+	GEN divs = subgroups_nonprime(stoi(36), 2);
+	GEN vec = mkvec2s(4, 6);
+	cr_assert(gequal(divs, vec), "Factors not equal!");
+}
+
+Test(subgroup, test_all_many_factors) {
+	// the primorial of the first 30 primes, 2^30 - 1 divisors without 1
+	GEN order = gen_1;
+	forprime_t iter;
+	u_forprime_init(&iter, 2, ULONG_MAX);
+	for (long i = 0; i < 30; ++i) {
+		order = muliu(order, u_forprime_next(&iter));
+	}
+	GEN divs = subgroups_all(order, 100);
+	cr_assert_eq(glength(divs), 100, );
+	cr_assert(gequal(gel(divs, 1), gen_2), );
+	for (long i = 2; i <= 100; ++i) {
+		cr_assert(cmpii(gel(divs, i - 1), gel(divs, i)) < 0, );
+		cr_assert(dvdii(order, gel(divs, i)), );
+	}
+}
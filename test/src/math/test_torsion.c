@@ -0,0 +1,65 @@
+/*
+ * ecgen, tool for generating Elliptic curve domain parameters
+ * Copyright (C) 2017-2018 J08nY
+ */
+#include <criterion/criterion.h>
+#include "math/torsion.h"
+#include "test/default.h"
+
+TestSuite(torsion, .init = default_setup, .fini = default_teardown);
+
+static curve_t torsion_curve(long a, long b, long p) {
+	GEN field = stoi(p);
+	GEN ga = mkintmodu((pari_ulong)a, (pari_ulong)p);
+	GEN gb = mkintmodu((pari_ulong)b, (pari_ulong)p);
+	curve_t curve = {.a = ga,
+	                 .b = gb,
+	                 .field = field,
+	                 .curve = ellinit(mkvec2(ga, gb), field, -1)};
+	return curve;
+}
+
+Test(torsion, test_torsion_divides) {
+	// order 24
+	curve_t curve = torsion_curve(3, 4, 23);
+	cr_assert(torsion_divides(&curve, 2), );
+	cr_assert(torsion_divides(&curve, 3), );
+	cr_assert_not(torsion_divides(&curve, 5), );
+}
+
+Test(torsion, test_torsion_odd) {
+	// order 27
+	curve_t curve = torsion_curve(1, 3, 23);
+	cr_assert_not(torsion_divides(&curve, 2), );
+	cr_assert(torsion_divides(&curve, 3), );
+}
+
+Test(torsion, test_torsion_twist) {
+	// order 31, the twist has order 33
+	curve_t curve = torsion_curve(4, 4, 31);
+	cr_assert_not(torsion_divides(&curve, 2), );
+	cr_assert_not(torsion_divides(&curve, 3), );
+	cr_assert_not(torsion_divides(&curve, 5), );
+}
+
+Test(torsion, test_torsion_divides_any) {
+	// order 31
+	curve_t curve = torsion_curve(4, 4, 31);
+	pari_ulong small[] = {2, 3, 5};
+	cr_assert_not(torsion_divides_any(&curve, small, 3, 5, false), );
+	pari_ulong large[] = {2, 7};
+	cr_assert(torsion_divides_any(&curve, large, 2, 5, false), );
+	pari_ulong equal[] = {31};
+	cr_assert(torsion_divides_any(&curve, equal, 1, 31, false), );
+	cr_assert_not(torsion_divides_any(&curve, NULL, 0, 5, false), );
+}
+
+Test(torsion, test_torsion_divides_any_twist) {
+	// order 31, the twist has order 33
+	curve_t curve = torsion_curve(4, 4, 31);
+	pari_ulong three[] = {3};
+	cr_assert_not(torsion_divides_any(&curve, three, 1, 3, false), );
+	cr_assert(torsion_divides_any(&curve, three, 1, 3, true), );
+	pari_ulong five[] = {5};
+	cr_assert_not(torsion_divides_any(&curve, five, 1, 5, true), );
+}
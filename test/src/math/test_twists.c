@@ -49,4 +49,41 @@ Test(twists, test_twist_rand_to_f2m) {
 	cr_assert_not_null(to.field, );
 	cr_assert_not_null(to.curve, );
 	cr_assert(equalii(to.order, stoi(8246)), );
-}
\ No newline at end of file
+}
+
+Test(twists, test_twist_same_a_to_fp) {
+	// p = 3 mod 4, the twist is (a, -b)
+	GEN a = mkintmodu(3, 23);
+	GEN b = mkintmodu(4, 23);
+	curve_t curve = {.a = a,
+	                 .b = b,
+	                 .field = stoi(23),
+	                 .curve = ellinit(mkvec2(a, b), stoi(23), -1),
+	                 .order = stoi(24)};
+
+	curve_t to = {0};
+	cr_assert(twist_same_a_to(&to, &curve), );
+	cr_assert(gequal(to.a, a), );
+	cr_assert(gequal(to.b, mkintmodu(19, 23)), );
+	cr_assert_not_null(to.curve, );
+	cr_assert(equalii(to.order, stoi(24)), );
+}
+
+Test(twists, test_twist_same_a_to_zero) {
+	// p = 1 mod 4, only a = 0 has such a twist
+	GEN a = mkintmodu(0, 13);
+	GEN b = mkintmodu(2, 13);
+	curve_t curve = {.a = a,
+	                 .b = b,
+	                 .field = stoi(13),
+	                 .curve = ellinit(mkvec2(a, b), stoi(13), -1),
+	                 .order = stoi(19)};
+
+	curve_t to = {0};
+	cr_assert(twist_same_a_to(&to, &curve), );
+	cr_assert(gequal0(to.a), );
+	cr_assert(equalii(to.order, stoi(9)), );
+
+	curve.a = mkintmodu(3, 13);
+	cr_assert_not(twist_keeps_a(&curve), );
+}
@@ -0,0 +1,46 @@
+/*
+ * ecgen, tool for generating Elliptic curve domain parameters
+ * Copyright (C) 2017-2018 J08nY
+ */
+
+#include <criterion/criterion.h>
+#include "test/default.h"
+#include "util/queue.h"
+
+TestSuite(queue, .init = default_setup, .fini = default_teardown);
+
+Test(queue, test_queue_fifo) {
+	queue_t *queue = queue_new(4);
+	int items[3] = {1, 2, 3};
+	for (size_t i = 0; i < 3; ++i) {
+		cr_assert(queue_push(queue, &items[i]), );
+	}
+	for (size_t i = 0; i < 3; ++i) {
+		int *item = queue_pop(queue);
+		cr_assert_eq(item, &items[i], );
+	}
+	queue_free(&queue);
+	cr_assert_null(queue, );
+}
+
+Test(queue, test_queue_wrap) {
+	queue_t *queue = queue_new(2);
+	int items[5] = {1, 2, 3, 4, 5};
+	for (size_t i = 0; i < 5; ++i) {
+		cr_assert(queue_push(queue, &items[i]), );
+		int *item = queue_pop(queue);
+		cr_assert_eq(*item, items[i], );
+	}
+	queue_free(&queue);
+}
+
+Test(queue, test_queue_close) {
+	queue_t *queue = queue_new(2);
+	int item = 1;
+	cr_assert(queue_push(queue, &item), );
+	queue_close(queue);
+	cr_assert_not(queue_push(queue, &item), );
+	cr_assert_eq(queue_pop(queue), &item, );
+	cr_assert_null(queue_pop(queue), );
+	queue_free(&queue);
+}
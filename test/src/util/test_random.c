@@ -55,4 +55,19 @@ Test(random, test_random_field_element_f2m) {
 		GEN j = random_field_element(f2m);
 		cr_assert_not_null(j, );
 	}
-}
\ No newline at end of file
+}
+
+Test(random, test_random_stream) {
+	cr_assert_not(random_stream(1), );
+
+	cfg->rng_seed = "0123456789abcdef";
+	cr_assert(random_stream(1), );
+	GEN one = random_int(64);
+	random_stream(2);
+	GEN two = random_int(64);
+	random_stream(1);
+	GEN again = random_int(64);
+	cr_assert(equalii(one, again), );
+	cr_assert_not(equalii(one, two), );
+	cfg->rng_seed = NULL;
+}